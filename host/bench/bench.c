@@ -0,0 +1,311 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Per-effect frame benchmark, running on the host mock backend
+ *
+ * Usage: [CUBEBIT_ANIMS=stream.bin] [CUBEBIT_OUTPUT=frame_tx] [CUBEBIT_TRANSITION=type]
+ *        cubebit_bench [frames] [scenario ...]
+ *
+ * Effects are stepped back to back with their nominal frame period as dt.
+ * "step ns" is the rendering time alone, "ns/frame" adds the output path
+ * (the transmit task runs in its own thread like on the target).
+ * The pixels are copied into led_strip mocks, or with CUBEBIT_OUTPUT=frame_tx,
+ * read from the framebuffer by frame_tx mocks; the hashes must not change.
+ *
+ * With CUBEBIT_TRANSITION (crossfade, wipe_x, wipe_y, wipe_z, dissolve),
+ * each pair of adjacent scenarios then goes through the transition path of
+ * the engine, stretched over the frame budget: both effects are stepped
+ * ("step ns") and blended ("blend ns") on each frame, which must fit in the
+ * period of the fastest one ("load").
+ */
+// Standard imports
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "led_strip.h"
+#include "host_shim.h"
+
+// Local imports
+#include "include/commons.h"
+#include "include/engine.h"
+#include "include/mapping.h"
+#include "include/output.h"
+#include "include/prng.h"
+#include "include/registry.h"
+#include "include/serial_link.h"
+
+#define DEFAULT_FRAMES    2000
+#define BENCH_SEED        0xC0BE
+#define FNV_PRIME         16777619u  // Folds the frame hashes of the channels
+
+static uint32_t s_frame_budget = DEFAULT_FRAMES;
+
+static const char *const s_transition_names[] = {
+    [TRANSITION_CROSSFADE] = "crossfade",
+    [TRANSITION_WIPE_X]    = "wipe_x",
+    [TRANSITION_WIPE_Y]    = "wipe_y",
+    [TRANSITION_WIPE_Z]    = "wipe_z",
+    [TRANSITION_DISSOLVE]  = "dissolve",
+};
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static bool is_selected(const char *name, int argc, char **argv) {
+    if (argc <= 2)
+        return true;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Get the transition of the given name
+ * @return TRANSITION_CUT if unknown
+ */
+static transition_type_t parse_transition(const char *name) {
+    for (uint8_t type = 0; type < sizeof(s_transition_names) / sizeof(s_transition_names[0]); type++) {
+        if (s_transition_names[type] && strcmp(s_transition_names[type], name) == 0)
+            return type;
+    }
+    return TRANSITION_CUT;
+}
+
+
+static void reset_strip_stats(const output_channel_t channels[LED_STRIP_CHANNELS]) {
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        if (channels[channel].led_strip)
+            led_strip_mock_reset_stats(channels[channel].led_strip);
+        else
+            frame_tx_mock_reset_stats(channels[channel].frame_tx);
+    }
+}
+
+
+static void get_channel_stats(const output_channel_t *channel, led_strip_mock_stats_t *stats) {
+    if (channel->led_strip)
+        led_strip_mock_get_stats(channel->led_strip, stats);
+    else
+        frame_tx_mock_get_stats(channel->frame_tx, stats);
+}
+
+
+/**
+ * @brief Sum the calls made on all the channels, and fold their hashes
+ * With one channel, the stats are the ones of the strip.
+ */
+static void get_strip_stats(const output_channel_t channels[LED_STRIP_CHANNELS], led_strip_mock_stats_t *stats) {
+    get_channel_stats(&channels[0], stats);
+    for (uint8_t channel = 1; channel < LED_STRIP_CHANNELS; channel++) {
+        led_strip_mock_stats_t channel_stats;
+        get_channel_stats(&channels[channel], &channel_stats);
+        stats->set_pixel_calls += channel_stats.set_pixel_calls;
+        stats->clear_calls += channel_stats.clear_calls;
+        stats->frames_hash = stats->frames_hash * FNV_PRIME ^ channel_stats.frames_hash;
+    }
+}
+
+
+/**
+ * @brief Drive the effect like the engine does, without waiting between frames
+ */
+static void run_effect(const effect_t *effect, const output_channel_t channels[LED_STRIP_CHANNELS]) {
+    led_strip_mock_stats_t stats;
+    output_stats_t output_stats;
+    uint64_t step_time = 0;
+
+    reset_strip_stats(channels);
+    output_reset_stats();
+
+    engine_usage_t usage;
+
+    uint64_t start = now_ns();
+    framebuffer_t *fb = output_get_back_buffer();
+    void *state = engine_begin(effect, fb);
+    if (!state)
+        return;
+
+    uint32_t dt_ms = 0;
+    for (uint32_t frame = 0; frame < s_frame_budget; frame++) {
+        uint64_t step_start = now_ns();
+        effect->step(state, dt_ms, fb);
+        step_time += now_ns() - step_start;
+
+        fb = output_present();
+        engine_sample_usage();
+        dt_ms = 1000 / effect->fps;
+    }
+    // Include the transmission of the last frames
+    output_flush();
+    uint64_t elapsed = now_ns() - start;
+
+    engine_end(effect, state, &usage);
+
+    get_strip_stats(channels, &stats);
+    output_get_stats(&output_stats);
+
+    printf("%-14s %8" PRIu32 " %10.1f %12.1f %14.2f %12.3f %10.3f %7zu %7" PRIu32 " %7" PRIu32 " %7.3f   %08" PRIx32 "\n",
+           effect->name, s_frame_budget,
+           (double) step_time / s_frame_budget,
+           (double) elapsed / s_frame_budget,
+           (double) stats.set_pixel_calls / s_frame_budget,
+           (double) stats.refresh_calls / s_frame_budget,
+           (double) output_stats.unchanged / s_frame_budget,
+           usage.arena_used, usage.heap_peak,
+           output_stats.peak_ma, (double) output_stats.limited / s_frame_budget,
+           stats.frames_hash);
+}
+
+
+
+/**
+ * @brief Fade from an effect to the next one like the engine does, without waiting between frames
+ * The transition lasts the frame budget at the rate of the fastest effect;
+ * only the blended frames are hashed.
+ */
+static void run_transition(const effect_t *from, const effect_t *to, transition_type_t type,
+                           const output_channel_t channels[LED_STRIP_CHANNELS]) {
+    led_strip_mock_stats_t stats;
+    uint64_t step_time = 0;
+    uint64_t blend_time = 0;
+    uint32_t frames = 0;
+    uint32_t period_ms = 1000 / MAX_(from->fps, to->fps);
+
+    framebuffer_t *fb = output_get_back_buffer();
+    void *from_state = engine_begin(from, fb);
+    if (!from_state)
+        return;
+    from->step(from_state, 0, fb);
+    fb = output_present();
+    output_flush();
+    reset_strip_stats(channels);
+
+    engine_set_transition(type, MIN_(s_frame_budget * period_ms, UINT16_MAX));
+    engine_transition_t transition;
+    void *to_state = engine_transition_begin(&transition, from, from_state, to, fb);
+    if (!to_state) {
+        printf("%-14s %-14s cut (different views or arena too small)\n", from->name, to->name);
+        engine_end(from, from_state, NULL);
+        return;
+    }
+
+    do {
+        uint64_t step_start = now_ns();
+        engine_transition_step(&transition);
+        uint64_t blend_start = now_ns();
+        engine_transition_blend(&transition, fb);
+        uint64_t blend_end = now_ns();
+        step_time += blend_start - step_start;
+        blend_time += blend_end - blend_start;
+
+        fb = output_present();
+        engine_sample_usage();
+        frames++;
+    } while (engine_transition_advance(&transition, period_ms));
+    output_flush();
+    get_strip_stats(channels, &stats);
+
+    engine_transition_end(&transition, fb);
+    engine_end(to, to_state, NULL);
+
+    printf("%-14s %-14s %8" PRIu32 " %10" PRIu32 " %10.1f %10.1f %7.2f%%   %08" PRIx32 "\n",
+           from->name, to->name, frames, period_ms * 1000000,
+           (double) step_time / frames, (double) blend_time / frames,
+           (double) (step_time + blend_time) * 100 / frames / (period_ms * 1000000.),
+           stats.frames_hash);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        s_frame_budget = strtoul(argv[1], NULL, 10);
+        if (s_frame_budget == 0) {
+            fprintf(stderr, "Usage: %s [frames] [scenario ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const char *output = getenv("CUBEBIT_OUTPUT");
+    bool zero_copy = output && strcmp(output, "frame_tx") == 0;
+    output_channel_t channels[LED_STRIP_CHANNELS] = { 0 };
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        if (zero_copy)
+            channels[channel].frame_tx = frame_tx_mock_new(LED_CHANNEL_LED_COUNT);
+        else
+            channels[channel].led_strip = led_strip_mock_new(LED_CHANNEL_LED_COUNT);
+        if (!channels[channel].led_strip && !channels[channel].frame_tx)
+            return EXIT_FAILURE;
+    }
+
+    // Same frames on every run
+    g_prng_seed = BENCH_SEED;
+    build_pix_map(&g_cubebit_wiring);
+    output_init(channels);
+    // Content of the animation partition played by the "player" effect
+    esp_partition_shim_set_file(getenv("CUBEBIT_ANIMS"));
+    // Nothing is sent to it: the "serial" scenario only measures the polling
+    serial_link_init();
+
+    printf("cube: %dx%dx%d, %d LEDs on %d channel(s) (%s), %" PRIu32 " frames per scenario\n",
+           SIDE_LENGTH, SIDE_LENGTH, SIDE_LENGTH, LED_STRIP_LED_COUNT, LED_STRIP_CHANNELS,
+           zero_copy ? "frame_tx" : "led_strip", s_frame_budget);
+    printf("%-14s %8s %10s %12s %14s %12s %10s %7s %7s %7s %7s   %s\n",
+           "scenario", "frames", "step ns", "ns/frame", "set_pixel/frm", "refresh/frm", "unchanged",
+           "arena", "heap", "peak mA", "limited", "hash");
+
+    for (uint8_t i = 0; i < g_effect_count; i++) {
+        if (is_selected(g_effects[i]->name, argc, argv))
+            run_effect(g_effects[i], channels);
+    }
+
+    const char *transition = getenv("CUBEBIT_TRANSITION");
+    if (transition) {
+        transition_type_t type = parse_transition(transition);
+        if (type == TRANSITION_CUT) {
+            fprintf(stderr, "Unknown transition: %s\n", transition);
+            return EXIT_FAILURE;
+        }
+        printf("\ntransitions: %s\n", transition);
+        printf("%-14s %-14s %8s %10s %10s %10s %8s   %s\n",
+               "from", "to", "frames", "period ns", "step ns", "blend ns", "load", "hash");
+
+        const effect_t *from = NULL;
+        for (uint8_t i = 0; i < g_effect_count; i++) {
+            if (!is_selected(g_effects[i]->name, argc, argv))
+                continue;
+            if (from)
+                run_transition(from, g_effects[i], type, channels);
+            from = g_effects[i];
+        }
+    }
+
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        if (zero_copy)
+            frame_tx_del(channels[channel].frame_tx);
+        else
+            led_strip_del(channels[channel].led_strip);
+    }
+    return EXIT_SUCCESS;
+}
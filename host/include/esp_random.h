@@ -0,0 +1,28 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host stand-in for the hardware RNG
+ *
+ * The sequence is deterministic so that two benchmark runs produce
+ * the same frames.
+ */
+#ifndef __HOST_ESP_RANDOM_H__
+#define __HOST_ESP_RANDOM_H__
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif // __HOST_ESP_RANDOM_H__
@@ -0,0 +1,31 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host stand-in for the ESP-IDF system functions
+ *
+ * The free heap is derived from the bytes allocated by the process
+ * out of a nominal heap of the size of the ESP32-C6 SRAM, so effects
+ * that allocate while they run show up in the reports.
+ */
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+
+#define HOST_HEAP_SIZE    (512 * 1024)
+
+uint32_t esp_get_free_heap_size(void);
+
+#endif // __HOST_ESP_SYSTEM_H__
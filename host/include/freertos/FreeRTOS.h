@@ -0,0 +1,45 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host stand-in for the FreeRTOS kernel types
+ */
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE    0
+#define pdTRUE     1
+#define pdPASS     pdTRUE
+#define pdFAIL     pdFALSE
+
+#define configMAX_PRIORITIES    25
+
+#define portMAX_DELAY    ((TickType_t) 0xffffffffUL)
+
+// Same as CONFIG_FREERTOS_HZ in sdkconfig.defaults
+#define configTICK_RATE_HZ    1000
+
+// There are no interrupts on the host
+#define portYIELD_FROM_ISR(x)    ((void) (x))
+
+#define pdMS_TO_TICKS(ms)    ((TickType_t) (((uint64_t) (ms) * configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(ticks) ((uint32_t) (((uint64_t) (ticks) * 1000U) / configTICK_RATE_HZ))
+
+#endif // __HOST_FREERTOS_H__
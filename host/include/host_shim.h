@@ -0,0 +1,44 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host-only controls of the FreeRTOS/ESP-IDF shims
+ */
+#ifndef __HOST_SHIM_H__
+#define __HOST_SHIM_H__
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "led_strip.h"
+#include "include/frame_tx.h"
+
+/**
+ * @brief Called on every vTaskDelay(), before the virtual clock moves forward
+ * Effects sleep once per frame, so this is where frames are counted.
+ */
+typedef void (*freertos_shim_delay_hook_t)(TickType_t ticks);
+
+void freertos_shim_set_delay_hook(freertos_shim_delay_hook_t hook);
+void freertos_shim_reset_ticks(void);
+
+void esp_random_shim_seed(uint32_t seed);
+void esp_partition_shim_set_file(const char *path);
+const char *uart_shim_get_pty_name(int uart_num);
+
+frame_tx_handle_t frame_tx_mock_new(uint32_t max_leds);
+void frame_tx_mock_get_stats(frame_tx_handle_t tx, led_strip_mock_stats_t *stats);
+void frame_tx_mock_reset_stats(frame_tx_handle_t tx);
+
+#endif // __HOST_SHIM_H__
@@ -0,0 +1,56 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host stand-in for the espressif/led_strip component
+ *
+ * The mock keeps its own pixel array like the real driver and records
+ * every call, see led_strip_mock_stats_t.
+ */
+#ifndef __HOST_LED_STRIP_H__
+#define __HOST_LED_STRIP_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+// The driver headers bring the FreeRTOS API along, the effects rely on it
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef struct led_strip_t *led_strip_handle_t;
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index,
+                              uint32_t red, uint32_t green, uint32_t blue);
+esp_err_t led_strip_refresh(led_strip_handle_t strip);
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip);
+esp_err_t led_strip_clear(led_strip_handle_t strip);
+esp_err_t led_strip_del(led_strip_handle_t strip);
+
+/** Host only **/
+
+typedef struct {
+    uint32_t set_pixel_calls;
+    uint32_t refresh_calls;
+    uint32_t clear_calls;
+    // FNV-1a hash of every refreshed frame, used to spot output regressions
+    uint32_t frames_hash;
+} led_strip_mock_stats_t;
+
+led_strip_handle_t led_strip_mock_new(uint32_t max_leds);
+void led_strip_mock_get_stats(led_strip_handle_t strip, led_strip_mock_stats_t *stats);
+void led_strip_mock_reset_stats(led_strip_handle_t strip);
+const uint8_t *led_strip_mock_get_pixels(led_strip_handle_t strip);
+
+#endif // __HOST_LED_STRIP_H__
@@ -0,0 +1,115 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Recording stand-in for the frame transmitter
+ *
+ * The stream is drained in chunks that cut the LEDs anywhere, like the
+ * RMT memory does on the target. The frames are kept and hashed like the
+ * led_strip mock does: both output paths give the same stats.
+ */
+// Standard imports
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "host_shim.h"
+#include "include/frame_tx.h"
+
+#define FNV_OFFSET_BASIS    2166136261u
+#define FNV_PRIME           16777619u
+// Not a multiple of 3: exercises the LEDs split between two reads
+#define MOCK_CHUNK_SIZE     16
+
+struct frame_tx_t {
+    uint32_t max_leds;
+    uint8_t *pixels;  // RGB, in strip order
+    led_strip_mock_stats_t stats;
+};
+
+
+frame_tx_handle_t frame_tx_mock_new(uint32_t max_leds) {
+    frame_tx_handle_t tx = calloc(1, sizeof(struct frame_tx_t));
+    if (!tx)
+        return NULL;
+
+    tx->pixels = calloc(max_leds, 3);
+    if (!tx->pixels) {
+        free(tx);
+        return NULL;
+    }
+    tx->max_leds = max_leds;
+    frame_tx_mock_reset_stats(tx);
+    return tx;
+}
+
+
+/**
+ * @brief The whole frame is "on the wire" as soon as it is triggered
+ */
+esp_err_t frame_tx_transmit(frame_tx_handle_t tx, strip_stream_t *stream) {
+    if (!tx || !stream)
+        return ESP_ERR_INVALID_ARG;
+
+    uint8_t chunk[MOCK_CHUNK_SIZE];
+    uint32_t byte = 0;
+    size_t size;
+    do {
+        size = strip_stream_read(stream, chunk, sizeof(chunk));
+        for (size_t i = 0; i < size && byte < tx->max_leds * 3; i++, byte++) {
+            // GRB on the wire
+            static const uint8_t rgb_offsets[3] = { 1, 0, 2 };
+            tx->pixels[byte - byte % 3 + rgb_offsets[byte % 3]] = chunk[i];
+        }
+    } while (size == sizeof(chunk));
+
+    uint32_t hash = tx->stats.frames_hash;
+    for (uint32_t i = 0; i < tx->max_leds * 3; i++) {
+        hash ^= tx->pixels[i];
+        hash *= FNV_PRIME;
+    }
+    tx->stats.frames_hash = hash;
+    tx->stats.refresh_calls++;
+    return ESP_OK;
+}
+
+
+esp_err_t frame_tx_wait_done(frame_tx_handle_t tx, int64_t *done_us) {
+    if (!tx)
+        return ESP_ERR_INVALID_ARG;
+    if (done_us)
+        *done_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+
+esp_err_t frame_tx_del(frame_tx_handle_t tx) {
+    if (!tx)
+        return ESP_ERR_INVALID_ARG;
+
+    free(tx->pixels);
+    free(tx);
+    return ESP_OK;
+}
+
+
+void frame_tx_mock_get_stats(frame_tx_handle_t tx, led_strip_mock_stats_t *stats) {
+    *stats = tx->stats;
+}
+
+
+void frame_tx_mock_reset_stats(frame_tx_handle_t tx) {
+    memset(&tx->stats, 0, sizeof(tx->stats));
+    tx->stats.frames_hash = FNV_OFFSET_BASIS;
+}
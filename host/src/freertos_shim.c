@@ -0,0 +1,313 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief FreeRTOS shim: pthread tasks with a virtual clock
+ *
+ * Blocking waits (portMAX_DELAY) really block on a condition variable.
+ * Finite timeouts don't: if the object is not available right away,
+ * the wait behaves like vTaskDelay() (the virtual clock moves forward by
+ * the timeout), then the object is checked one last time.
+ * A zero timeout is a simple poll.
+ */
+// Standard imports
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#include "host_shim.h"
+
+struct host_task {
+    TaskFunction_t code;
+    void *parameters;
+    uint32_t notification;
+    pthread_cond_t cond;
+};
+
+struct host_semaphore {
+    uint32_t count;
+    uint32_t max_count;
+    pthread_cond_t cond;
+};
+
+struct host_queue {
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+};
+
+// All the kernel objects are protected by this single lock
+static pthread_mutex_t s_kernel_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread TaskHandle_t s_current_task = NULL;
+
+static TickType_t s_ticks = 0;
+static freertos_shim_delay_hook_t s_delay_hook = NULL;
+
+
+void freertos_shim_set_delay_hook(freertos_shim_delay_hook_t hook) {
+    s_delay_hook = hook;
+}
+
+
+void freertos_shim_reset_ticks(void) {
+    __atomic_store_n(&s_ticks, 0, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * @brief Expire a finite timeout, called and returns with the kernel lock held
+ */
+static void timed_wait(TickType_t ticks) {
+    if (!ticks)
+        return;
+
+    pthread_mutex_unlock(&s_kernel_lock);
+    vTaskDelay(ticks);
+    pthread_mutex_lock(&s_kernel_lock);
+}
+
+
+static TaskHandle_t new_task(TaskFunction_t code, void *parameters) {
+    TaskHandle_t task = calloc(1, sizeof(struct host_task));
+    if (!task)
+        return NULL;
+
+    task->code = code;
+    task->parameters = parameters;
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+
+static void *task_entry(void *arg) {
+    s_current_task = arg;
+    s_current_task->code(s_current_task->parameters);
+    return NULL;
+}
+
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *const pcName,
+                       const uint32_t usStackDepth, void *const pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *const pxCreatedTask) {
+    (void) pcName;
+    (void) usStackDepth;
+    (void) uxPriority;
+    pthread_t thread;
+
+    TaskHandle_t task = new_task(pxTaskCode, pvParameters);
+    if (!task)
+        return pdFAIL;
+
+    if (pthread_create(&thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+
+    if (pxCreatedTask)
+        *pxCreatedTask = task;
+    return pdPASS;
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    // Threads not created by xTaskCreate (i.e. main) get a handle on demand
+    if (!s_current_task)
+        s_current_task = new_task(NULL, NULL);
+    return s_current_task;
+}
+
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+    if (s_delay_hook)
+        s_delay_hook(xTicksToDelay);
+
+    __atomic_add_fetch(&s_ticks, xTicksToDelay, __ATOMIC_RELAXED);
+}
+
+
+TickType_t xTaskGetTickCount(void) {
+    return __atomic_load_n(&s_ticks, __ATOMIC_RELAXED);
+}
+
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+    (void) xTask;
+    return 0;
+}
+
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    pthread_mutex_lock(&s_kernel_lock);
+    xTaskToNotify->notification++;
+    pthread_cond_signal(&xTaskToNotify->cond);
+    pthread_mutex_unlock(&s_kernel_lock);
+    return pdPASS;
+}
+
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    pthread_mutex_lock(&s_kernel_lock);
+    if (xTicksToWait == portMAX_DELAY) {
+        while (task->notification == 0)
+            pthread_cond_wait(&task->cond, &s_kernel_lock);
+    } else if (task->notification == 0) {
+        timed_wait(xTicksToWait);
+    }
+
+    uint32_t value = task->notification;
+    if (value)
+        task->notification = xClearCountOnExit ? 0 : value - 1;
+    pthread_mutex_unlock(&s_kernel_lock);
+    return value;
+}
+
+
+static SemaphoreHandle_t new_semaphore(uint32_t max_count, uint32_t initial_count) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(struct host_semaphore));
+    if (!semaphore)
+        return NULL;
+
+    semaphore->max_count = max_count;
+    semaphore->count = initial_count;
+    pthread_cond_init(&semaphore->cond, NULL);
+    return semaphore;
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return new_semaphore(1, 0);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return new_semaphore(1, 1);
+}
+
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&s_kernel_lock);
+    if (xSemaphore->count < xSemaphore->max_count) {
+        xSemaphore->count++;
+        pthread_cond_signal(&xSemaphore->cond);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&s_kernel_lock);
+    return ret;
+}
+
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&s_kernel_lock);
+    if (xBlockTime == portMAX_DELAY) {
+        while (xSemaphore->count == 0)
+            pthread_cond_wait(&xSemaphore->cond, &s_kernel_lock);
+    } else if (xSemaphore->count == 0) {
+        timed_wait(xBlockTime);
+    }
+
+    if (xSemaphore->count) {
+        xSemaphore->count--;
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&s_kernel_lock);
+    return ret;
+}
+
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    QueueHandle_t queue = calloc(1, sizeof(struct host_queue));
+    if (!queue)
+        return NULL;
+
+    queue->items = calloc(uxQueueLength, uxItemSize);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = uxQueueLength;
+    queue->item_size = uxItemSize;
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return queue;
+}
+
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&s_kernel_lock);
+    if (xTicksToWait == portMAX_DELAY) {
+        while (xQueue->count == xQueue->length)
+            pthread_cond_wait(&xQueue->not_full, &s_kernel_lock);
+    } else if (xQueue->count == xQueue->length) {
+        timed_wait(xTicksToWait);
+    }
+
+    if (xQueue->count < xQueue->length) {
+        UBaseType_t tail = (xQueue->head + xQueue->count) % xQueue->length;
+        memcpy(&xQueue->items[tail * xQueue->item_size], pvItemToQueue, xQueue->item_size);
+        xQueue->count++;
+        pthread_cond_signal(&xQueue->not_empty);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&s_kernel_lock);
+    return ret;
+}
+
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue,
+                             BaseType_t *pxHigherPriorityTaskWoken) {
+    if (pxHigherPriorityTaskWoken)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    return xQueueSend(xQueue, pvItemToQueue, 0);
+}
+
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&s_kernel_lock);
+    if (xTicksToWait == portMAX_DELAY) {
+        while (xQueue->count == 0)
+            pthread_cond_wait(&xQueue->not_empty, &s_kernel_lock);
+    } else if (xQueue->count == 0) {
+        timed_wait(xTicksToWait);
+    }
+
+    if (xQueue->count) {
+        memcpy(pvBuffer, &xQueue->items[xQueue->head * xQueue->item_size], xQueue->item_size);
+        xQueue->head = (xQueue->head + 1) % xQueue->length;
+        xQueue->count--;
+        pthread_cond_signal(&xQueue->not_full);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&s_kernel_lock);
+    return ret;
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Recording stand-in for the led_strip driver
+ */
+// Standard imports
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_strip.h"
+
+#define FNV_OFFSET_BASIS    2166136261u
+#define FNV_PRIME           16777619u
+
+struct led_strip_t {
+    uint32_t max_leds;
+    uint8_t *pixels;  // RGB, in strip order
+    led_strip_mock_stats_t stats;
+};
+
+
+led_strip_handle_t led_strip_mock_new(uint32_t max_leds) {
+    led_strip_handle_t strip = calloc(1, sizeof(struct led_strip_t));
+    if (!strip)
+        return NULL;
+
+    strip->pixels = calloc(max_leds, 3);
+    if (!strip->pixels) {
+        free(strip);
+        return NULL;
+    }
+    strip->max_leds = max_leds;
+    led_strip_mock_reset_stats(strip);
+    return strip;
+}
+
+
+esp_err_t led_strip_del(led_strip_handle_t strip) {
+    if (!strip)
+        return ESP_ERR_INVALID_ARG;
+
+    free(strip->pixels);
+    free(strip);
+    return ESP_OK;
+}
+
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index,
+                              uint32_t red, uint32_t green, uint32_t blue) {
+    if (!strip || index >= strip->max_leds)
+        return ESP_ERR_INVALID_ARG;
+
+    uint8_t *pixel = &strip->pixels[index * 3];
+    pixel[0] = red;
+    pixel[1] = green;
+    pixel[2] = blue;
+    strip->stats.set_pixel_calls++;
+    return ESP_OK;
+}
+
+
+/**
+ * @brief The frame is "on the wire" as soon as it is triggered
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip) {
+    if (!strip)
+        return ESP_ERR_INVALID_ARG;
+
+    uint32_t hash = strip->stats.frames_hash;
+    for (uint32_t i = 0; i < strip->max_leds * 3; i++) {
+        hash ^= strip->pixels[i];
+        hash *= FNV_PRIME;
+    }
+    strip->stats.frames_hash = hash;
+    strip->stats.refresh_calls++;
+    return ESP_OK;
+}
+
+
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip) {
+    if (!strip)
+        return ESP_ERR_INVALID_ARG;
+
+    return ESP_OK;
+}
+
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip) {
+    esp_err_t ret = led_strip_refresh_async(strip);
+    if (ret != ESP_OK)
+        return ret;
+    return led_strip_refresh_wait_done(strip);
+}
+
+
+esp_err_t led_strip_clear(led_strip_handle_t strip) {
+    if (!strip)
+        return ESP_ERR_INVALID_ARG;
+
+    // The real driver also pushes the blank frame on the wire
+    memset(strip->pixels, 0, strip->max_leds * 3);
+    strip->stats.clear_calls++;
+    return led_strip_refresh(strip);
+}
+
+
+void led_strip_mock_get_stats(led_strip_handle_t strip, led_strip_mock_stats_t *stats) {
+    *stats = strip->stats;
+}
+
+
+void led_strip_mock_reset_stats(led_strip_handle_t strip) {
+    memset(&strip->stats, 0, sizeof(strip->stats));
+    strip->stats.frames_hash = FNV_OFFSET_BASIS;
+}
+
+
+const uint8_t *led_strip_mock_get_pixels(led_strip_handle_t strip) {
+    return strip->pixels;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host implementation of the partition API over a file
+ */
+// Standard imports
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_partition.h"
+
+#include "host_shim.h"
+#include "include/stream.h"
+
+// Only one mapping at a time, its handle is 1
+static const char *s_path = NULL;
+static esp_partition_t s_partition;
+static void *s_mapping = NULL;
+static size_t s_mapping_size;
+
+
+/**
+ * @brief Use the given file as the content of the animation partition
+ * @param path NULL: no animation partition
+ */
+void esp_partition_shim_set_file(const char *path) {
+    s_path = path;
+}
+
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype, const char *label) {
+    struct stat st;
+
+    if (!s_path || type != ESP_PARTITION_TYPE_DATA || subtype != STREAM_PARTITION_SUBTYPE
+        || (label && strcmp(label, STREAM_PARTITION_LABEL) != 0))
+        return NULL;
+
+    if (stat(s_path, &st) != 0)
+        return NULL;
+
+    s_partition = (esp_partition_t){
+        .type    = type,
+        .subtype = subtype,
+        .size    = st.st_size,
+    };
+    strcpy(s_partition.label, STREAM_PARTITION_LABEL);
+    return &s_partition;
+}
+
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory,
+                             const void **out_ptr, esp_partition_mmap_handle_t *out_handle) {
+    (void) memory;
+
+    if (partition != &s_partition || offset + size > partition->size || !size)
+        return ESP_ERR_INVALID_ARG;
+    if (s_mapping)
+        return ESP_ERR_NO_MEM;
+
+    int fd = open(s_path, O_RDONLY);
+    if (fd < 0)
+        return ESP_ERR_NOT_FOUND;
+
+    // The offset of mmap() must be page aligned
+    size_t page_offset = offset % sysconf(_SC_PAGESIZE);
+    s_mapping_size = size + page_offset;
+    s_mapping = mmap(NULL, s_mapping_size, PROT_READ, MAP_PRIVATE, fd, offset - page_offset);
+    close(fd);
+    if (s_mapping == MAP_FAILED) {
+        s_mapping = NULL;
+        return ESP_FAIL;
+    }
+
+    *out_ptr = (uint8_t *) s_mapping + page_offset;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle) {
+    if (handle != 1 || !s_mapping)
+        return;
+
+    munmap(s_mapping, s_mapping_size);
+    s_mapping = NULL;
+}
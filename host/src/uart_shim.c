@@ -0,0 +1,101 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Host implementation of the UART driver over pseudo-terminals
+ */
+// Standard imports
+#define _GNU_SOURCE  // ptsname_r
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "driver/uart.h"
+
+#include "host_shim.h"
+
+typedef struct {
+    int master;
+    int slave;       // Kept open so the master never reads EOF
+    char name[64];
+} pty_t;
+
+static pty_t s_ports[UART_NUM_MAX];
+
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    (void) rx_buffer_size;
+    (void) tx_buffer_size;
+    (void) queue_size;
+    (void) uart_queue;
+    (void) intr_alloc_flags;
+
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || s_ports[uart_num].master)
+        return ESP_ERR_INVALID_ARG;
+
+    pty_t *port = &s_ports[uart_num];
+    port->master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (port->master < 0 || grantpt(port->master) != 0 || unlockpt(port->master) != 0
+        || ptsname_r(port->master, port->name, sizeof(port->name)) != 0)
+        return ESP_FAIL;
+
+    // Raw bytes, no echo
+    port->slave = open(port->name, O_RDWR | O_NOCTTY);
+    struct termios attributes;
+    if (port->slave < 0 || tcgetattr(port->slave, &attributes) != 0)
+        return ESP_FAIL;
+    cfmakeraw(&attributes);
+    tcsetattr(port->slave, TCSANOW, &attributes);
+    return ESP_OK;
+}
+
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    (void) uart_config;
+    return (uart_num >= 0 && uart_num < UART_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    struct pollfd fd = { .fd = s_ports[uart_num].master, .events = POLLIN };
+
+    if (poll(&fd, 1, pdTICKS_TO_MS(ticks_to_wait)) <= 0)
+        return 0;
+    return read(fd.fd, buf, length);
+}
+
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    const uint8_t *data = src;
+    size_t written = 0;
+
+    while (written < size) {
+        ssize_t ret = write(s_ports[uart_num].master, data + written, size - written);
+        if (ret < 0)
+            return -1;
+        written += ret;
+    }
+    return written;
+}
+
+
+/**
+ * @brief Path of the pseudo-terminal to open to talk to the given port
+ */
+const char *uart_shim_get_pty_name(uart_port_t uart_num) {
+    return s_ports[uart_num].name;
+}
@@ -0,0 +1,600 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Animation compiler: frame sequences to the flash frame-stream format
+ *
+ * Usage: cubebit_animc [options] -o stream.bin (--csv file | --json file | --effect name)
+ *
+ * Inputs:
+ *  - CSV: one lit voxel per line: frame,x,y,z,r,g,b; the other voxels are off.
+ *  - JSON: {"fps": 25, "frames": [[[x, y, z, r, g, b], ...], ...]}
+ *  - effect: frames captured from a registered effect stepped at its frame rate.
+ *
+ * Each frame is encoded as a keyframe or a delta, whichever is cheaper.
+ * The ops of a frame are chosen by dynamic programming to minimize
+ * size + lambda * decode cost; lambda is raised until the frame fits in
+ * the decode budget (--max-decode, in cost units, see DECODE_COST_*).
+ * The stream is then decoded with the firmware decoder to check it and
+ * to measure the worst-case decode time.
+ */
+// Standard imports
+#include <ctype.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_shim.h"
+
+// Local imports
+#include "include/commons.h"
+#include "include/engine.h"
+#include "include/mapping.h"
+#include "include/prng.h"
+#include "include/registry.h"
+#include "include/stream.h"
+
+#define VOXEL_COUNT           (SIDE_LENGTH * SIDE_LENGTH * SIDE_LENGTH)
+#define DEFAULT_FPS           25
+#define DEFAULT_FRAMES        500
+#define CAPTURE_SEED          0xC0BE
+
+// Decode cost model, in units of ~1 pixel write on the host decoder
+#define DECODE_COST_OP        2
+#define DECODE_COST_PIXEL     2
+#define DECODE_COST_CLEAR     (VOXEL_COUNT / 16)
+
+// Score = 16 * bytes + lambda * cost: lambda is in 1/16 byte per cost unit
+#define LAMBDA_MAX            4096
+
+typedef struct {
+    color_t *frames;        // frame_count * VOXEL_COUNT pixels, framebuffer order
+    uint32_t frame_count;
+    uint32_t capacity;
+    uint16_t fps;
+} animation_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} buffer_t;
+
+typedef struct {
+    uint8_t code;           // STREAM_OP_*
+    uint16_t start;
+    uint8_t count;
+} op_t;
+
+// Encoding of one frame
+typedef struct {
+    uint8_t type;           // STREAM_FRAME_*
+    uint16_t op_count;
+    uint32_t bytes;         // Payload
+    uint32_t cost;          // Decode cost units
+    op_t ops[VOXEL_COUNT];
+} encoding_t;
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static void *xrealloc(void *ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (!ptr) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+
+static void buffer_append(buffer_t *buffer, const void *data, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = MAX_(buffer->capacity * 2, buffer->size + size);
+        buffer->data = xrealloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+
+static void buffer_append_le(buffer_t *buffer, uint32_t value, uint8_t bytes) {
+    uint8_t data[4] = { value, value >> 8, value >> 16, value >> 24 };
+    buffer_append(buffer, data, bytes);
+}
+
+
+/**
+ * @brief Get a black frame at the end of the animation
+ */
+static color_t *animation_add_frame(animation_t *anim) {
+    if (anim->frame_count == anim->capacity) {
+        anim->capacity = MAX_(64, anim->capacity * 2);
+        anim->frames = xrealloc(anim->frames, (size_t) anim->capacity * VOXEL_COUNT * sizeof(color_t));
+    }
+    color_t *frame = &anim->frames[(size_t) anim->frame_count++ * VOXEL_COUNT];
+    memset(frame, 0, VOXEL_COUNT * sizeof(color_t));
+    return frame;
+}
+
+
+static bool set_voxel(animation_t *anim, uint32_t frame, const long values[6]) {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (values[i] < 0 || values[i] >= SIDE_LENGTH)
+            return false;
+    }
+    for (uint8_t i = 3; i < 6; i++) {
+        if (values[i] < 0 || values[i] > 255)
+            return false;
+    }
+
+    while (anim->frame_count <= frame)
+        animation_add_frame(anim);
+
+    color_t *pixel = &anim->frames[(size_t) frame * VOXEL_COUNT
+                                   + (values[0] * SIDE_LENGTH + values[1]) * SIDE_LENGTH + values[2]];
+    *pixel = (color_t){ .red = values[3], .green = values[4], .blue = values[5] };
+    return true;
+}
+
+
+/**
+ * @brief Load a CSV dump: frame,x,y,z,r,g,b per line
+ * Lines not starting with a digit (header, comments) are ignored.
+ */
+static bool load_csv(animation_t *anim, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    uint32_t line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        if (!isdigit((unsigned char) line[0]))
+            continue;
+
+        long frame;
+        long values[6];
+        if (sscanf(line, "%ld,%ld,%ld,%ld,%ld,%ld,%ld", &frame, &values[0], &values[1], &values[2],
+                   &values[3], &values[4], &values[5]) != 7 || frame < 0
+            || !set_voxel(anim, frame, values)) {
+            fprintf(stderr, "%s:%" PRIu32 ": invalid voxel\n", path, line_number);
+            ok = false;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+
+static char *read_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    buffer_t buffer = { 0 };
+    char chunk[4096];
+    size_t size;
+    while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        buffer_append(&buffer, chunk, size);
+    buffer_append(&buffer, "", 1);
+    fclose(file);
+    return (char *) buffer.data;
+}
+
+
+/**
+ * @brief Load a JSON dump: {"fps": 25, "frames": [[[x, y, z, r, g, b], ...], ...]}
+ * Only this structure is understood; "fps" is optional.
+ */
+static bool load_json(animation_t *anim, const char *path) {
+    char *text = read_file(path);
+    if (!text)
+        return false;
+
+    const char *fps = strstr(text, "\"fps\"");
+    if (fps && (fps = strchr(fps, ':')))
+        anim->fps = strtoul(fps + 1, NULL, 10);
+
+    const char *cursor = strstr(text, "\"frames\"");
+    cursor = cursor ? strchr(cursor, '[') : NULL;
+    if (!cursor) {
+        fprintf(stderr, "%s: no frames\n", path);
+        free(text);
+        return false;
+    }
+
+    // Depth 1: list of frames, 2: frame, 3: voxel
+    uint8_t depth = 0;
+    uint8_t value_count = 0;
+    long values[6];
+    bool ok = true;
+    for (; *cursor && ok; cursor++) {
+        if (*cursor == '[') {
+            depth++;
+            if (depth == 2)
+                animation_add_frame(anim);
+            value_count = 0;
+            ok = depth <= 3;
+        } else if (*cursor == ']') {
+            if (depth == 3)
+                ok = value_count == 6 && set_voxel(anim, anim->frame_count - 1, values);
+            if (--depth == 0)
+                break;
+        } else if (depth == 3 && (isdigit((unsigned char) *cursor) || *cursor == '-')) {
+            char *end;
+            long value = strtol(cursor, &end, 10);
+            if (value_count < 6)
+                values[value_count] = value;
+            value_count++;
+            cursor = end - 1;
+        }
+    }
+    free(text);
+
+    if (!ok || depth)
+        fprintf(stderr, "%s: invalid frames\n", path);
+    return ok && !depth;
+}
+
+
+/**
+ * @brief Capture the frames rendered by a registered effect
+ */
+static bool capture_effect(animation_t *anim, const char *name, uint32_t frame_count) {
+    const effect_t *effect = NULL;
+    for (uint8_t i = 0; i < g_effect_count; i++) {
+        if (strcmp(g_effects[i]->name, name) == 0)
+            effect = g_effects[i];
+    }
+    if (!effect) {
+        fprintf(stderr, "Unknown effect: %s\n", name);
+        return false;
+    }
+
+    static framebuffer_t fb;
+    g_prng_seed = CAPTURE_SEED;
+    build_pix_map(&g_cubebit_wiring);
+    void *state = engine_begin(effect, &fb);
+    if (!state)
+        return false;
+
+    uint32_t dt_ms = 0;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        effect->step(state, dt_ms, &fb);
+        memcpy(animation_add_frame(anim), fb.pixels, sizeof(fb.pixels));
+        dt_ms = 1000 / effect->fps;
+    }
+    engine_end(effect, state, NULL);
+    anim->fps = effect->fps;
+    return true;
+}
+
+
+static inline bool same_color(color_t a, color_t b) {
+    return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+
+static inline bool is_black(color_t color) {
+    return !color.red && !color.green && !color.blue;
+}
+
+
+/**
+ * @brief Choose the ops of a frame, given the colors to XOR with the reference frame
+ * @return The score (16 * bytes + lambda * cost)
+ */
+static uint64_t plan_ops(const color_t xor[VOXEL_COUNT], uint32_t lambda, uint8_t type,
+                         encoding_t *encoding) {
+    // Best score of the pixels [0; i[, the last op being closed (score)
+    // or a literal that can be extended (lit_score)
+    static uint64_t score[VOXEL_COUNT + 1];
+    static uint64_t lit_score[VOXEL_COUNT + 1];
+    static uint16_t lit_start[VOXEL_COUNT + 1];
+    static uint16_t from[VOXEL_COUNT + 1];
+    static uint8_t code[VOXEL_COUNT + 1];
+    static uint8_t same_run[VOXEL_COUNT];
+    const uint64_t op_score = 16 + lambda * DECODE_COST_OP;
+    const uint64_t pixel_score = 16 * 3 + lambda * DECODE_COST_PIXEL;
+
+    // Lengths of the runs of identical colors, capped to an op
+    same_run[VOXEL_COUNT - 1] = 1;
+    for (int i = VOXEL_COUNT - 2; i >= 0; i--) {
+        same_run[i] = (same_color(xor[i], xor[i + 1]) && same_run[i + 1] < STREAM_OP_MAX_PIXELS)
+            ? same_run[i + 1] + 1 : 1;
+    }
+
+    for (uint16_t i = 0; i <= VOXEL_COUNT; i++) {
+        score[i] = UINT64_MAX;
+        lit_score[i] = UINT64_MAX;
+    }
+    score[0] = 0;
+
+    for (uint16_t i = 0; i < VOXEL_COUNT; i++) {
+        // Close the literal ending here
+        if (lit_score[i] < score[i]) {
+            score[i] = lit_score[i];
+            from[i] = lit_start[i];
+            code[i] = STREAM_OP_LITERAL;
+        }
+
+        // Extend the literal or start a new one
+        uint64_t extended = (lit_score[i] != UINT64_MAX && i - lit_start[i] < STREAM_OP_MAX_PIXELS)
+            ? lit_score[i] + pixel_score : UINT64_MAX;
+        uint64_t started = score[i] + op_score + pixel_score;
+        if (extended <= started) {
+            lit_score[i + 1] = extended;
+            lit_start[i + 1] = lit_start[i];
+        } else {
+            lit_score[i + 1] = started;
+            lit_start[i + 1] = i;
+        }
+
+        uint16_t end = i + same_run[i];
+        uint64_t candidate;
+        if (is_black(xor[i])) {
+            candidate = score[i] + op_score;
+            if (candidate < score[end]) {
+                score[end] = candidate;
+                from[end] = i;
+                code[end] = STREAM_OP_SKIP;
+            }
+        } else if (same_run[i] > 1) {
+            candidate = score[i] + op_score + 16 * 3 + lambda * DECODE_COST_PIXEL * same_run[i];
+            if (candidate < score[end]) {
+                score[end] = candidate;
+                from[end] = i;
+                code[end] = STREAM_OP_RUN;
+            }
+        }
+    }
+    if (lit_score[VOXEL_COUNT] < score[VOXEL_COUNT]) {
+        score[VOXEL_COUNT] = lit_score[VOXEL_COUNT];
+        from[VOXEL_COUNT] = lit_start[VOXEL_COUNT];
+        code[VOXEL_COUNT] = STREAM_OP_LITERAL;
+    }
+
+    // Walk back the chosen ops
+    uint16_t op_count = 0;
+    for (uint16_t i = VOXEL_COUNT; i > 0; i = from[i])
+        op_count++;
+
+    encoding->type = type;
+    encoding->op_count = op_count;
+    encoding->bytes = 0;
+    encoding->cost = (type == STREAM_FRAME_KEY) ? DECODE_COST_CLEAR : 0;
+    for (uint16_t i = VOXEL_COUNT; i > 0; i = from[i]) {
+        op_t *op = &encoding->ops[--op_count];
+        *op = (op_t){ .code = code[i], .start = from[i], .count = i - from[i] };
+
+        encoding->bytes += 1;
+        encoding->cost += DECODE_COST_OP;
+        if (op->code == STREAM_OP_LITERAL)
+            encoding->bytes += 3 * op->count;
+        else if (op->code == STREAM_OP_RUN)
+            encoding->bytes += 3;
+        if (op->code != STREAM_OP_SKIP)
+            encoding->cost += DECODE_COST_PIXEL * op->count;
+    }
+    return score[VOXEL_COUNT];
+}
+
+
+/**
+ * @brief Encode a frame as a keyframe or a delta, within the decode budget if possible
+ * @param previous NULL to force a keyframe
+ * @return false if the frame doesn't fit in the budget
+ */
+static bool encode_frame(const color_t *frame, const color_t *previous, uint32_t max_cost,
+                         encoding_t *encoding) {
+    static color_t xor[VOXEL_COUNT];
+    static encoding_t candidate;
+
+    for (uint32_t lambda = 0; ; lambda = lambda ? lambda * 2 : 1) {
+        uint64_t best = plan_ops(frame, lambda, STREAM_FRAME_KEY, encoding);
+
+        if (previous) {
+            for (uint16_t i = 0; i < VOXEL_COUNT; i++) {
+                xor[i] = (color_t){
+                    .red   = frame[i].red ^ previous[i].red,
+                    .green = frame[i].green ^ previous[i].green,
+                    .blue  = frame[i].blue ^ previous[i].blue,
+                };
+            }
+            uint64_t delta = plan_ops(xor, lambda, STREAM_FRAME_DELTA, &candidate);
+            // Same size: the delta is cheaper to decode (no clear)
+            if (delta < best || (delta == best && candidate.cost <= encoding->cost))
+                *encoding = candidate;
+        }
+
+        if (!max_cost || encoding->cost <= max_cost)
+            return true;
+        if (lambda >= LAMBDA_MAX)
+            return false;
+    }
+}
+
+
+static void write_ops(buffer_t *stream, const encoding_t *encoding, const color_t *xor_source,
+                      const color_t *previous) {
+    for (uint16_t i = 0; i < encoding->op_count; i++) {
+        const op_t *op = &encoding->ops[i];
+        uint8_t token = (op->code << 6) | (op->count - 1);
+        buffer_append(stream, &token, 1);
+
+        if (op->code == STREAM_OP_SKIP)
+            continue;
+
+        uint8_t pixels = (op->code == STREAM_OP_LITERAL) ? op->count : 1;
+        for (uint16_t p = op->start; p < op->start + pixels; p++) {
+            color_t color = xor_source[p];
+            if (previous) {
+                color.red ^= previous[p].red;
+                color.green ^= previous[p].green;
+                color.blue ^= previous[p].blue;
+            }
+            buffer_append(stream, &color, 3);
+        }
+    }
+}
+
+
+/**
+ * @brief Decode the stream with the firmware decoder, compare it to the input
+ * @return false if a frame differs
+ */
+static bool verify_stream(const buffer_t *stream, const animation_t *anim, uint64_t *worst_ns) {
+    static framebuffer_t fb;
+    stream_t decoder;
+
+    if (stream_open(&decoder, stream->data, stream->size) != ESP_OK)
+        return false;
+
+    *worst_ns = 0;
+    for (uint32_t i = 0; i < anim->frame_count; i++) {
+        uint64_t start = now_ns();
+        esp_err_t ret = stream_decode_next(&decoder, &fb);
+        *worst_ns = MAX_(*worst_ns, now_ns() - start);
+
+        if (ret != ESP_OK || memcmp(fb.pixels, &anim->frames[(size_t) i * VOXEL_COUNT],
+                                    sizeof(fb.pixels)) != 0) {
+            fprintf(stderr, "Frame %" PRIu32 " doesn't decode to the input\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options] -o stream.bin (--csv file | --json file | --effect name)\n"
+            "  --frames N        frames captured from the effect (default %d)\n"
+            "  --fps N           frame rate of CSV/JSON inputs (default %d)\n"
+            "  --key-interval N  force a keyframe every N frames (default: first frame only)\n"
+            "  --max-decode N    decode budget per frame, in cost units (default: none)\n",
+            program, DEFAULT_FRAMES, DEFAULT_FPS);
+}
+
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        { "csv",          required_argument, NULL, 'c' },
+        { "json",         required_argument, NULL, 'j' },
+        { "effect",       required_argument, NULL, 'e' },
+        { "frames",       required_argument, NULL, 'n' },
+        { "fps",          required_argument, NULL, 'f' },
+        { "key-interval", required_argument, NULL, 'k' },
+        { "max-decode",   required_argument, NULL, 'm' },
+        { "output",       required_argument, NULL, 'o' },
+        { NULL,           0,                 NULL, 0 },
+    };
+    const char *csv = NULL, *json = NULL, *effect = NULL, *output = NULL;
+    uint32_t capture_frames = DEFAULT_FRAMES, key_interval = 0, max_cost = 0;
+    animation_t anim = { .fps = DEFAULT_FPS };
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "o:", options, NULL)) != -1) {
+        switch (opt) {
+            case 'c': csv = optarg; break;
+            case 'j': json = optarg; break;
+            case 'e': effect = optarg; break;
+            case 'n': capture_frames = strtoul(optarg, NULL, 10); break;
+            case 'f': anim.fps = strtoul(optarg, NULL, 10); break;
+            case 'k': key_interval = strtoul(optarg, NULL, 10); break;
+            case 'm': max_cost = strtoul(optarg, NULL, 10); break;
+            case 'o': output = optarg; break;
+            default: usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    if (!output || (!!csv + !!json + !!effect) != 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t start = now_ns();
+    bool loaded = csv ? load_csv(&anim, csv)
+                : json ? load_json(&anim, json)
+                : capture_effect(&anim, effect, capture_frames);
+    if (!loaded || !anim.frame_count || !anim.fps) {
+        fprintf(stderr, "No frames to compile\n");
+        return EXIT_FAILURE;
+    }
+
+    static encoding_t encoding;
+    buffer_t records = { 0 };
+    uint32_t keyframes = 0, worst_cost = 0, over_budget = 0;
+    for (uint32_t i = 0; i < anim.frame_count; i++) {
+        const color_t *frame = &anim.frames[(size_t) i * VOXEL_COUNT];
+        bool force_key = i == 0 || (key_interval && i % key_interval == 0);
+        const color_t *previous = force_key ? NULL : frame - VOXEL_COUNT;
+
+        if (!encode_frame(frame, previous, max_cost, &encoding))
+            over_budget++;
+        if (encoding.type == STREAM_FRAME_KEY)
+            keyframes++;
+        worst_cost = MAX_(worst_cost, encoding.cost);
+
+        buffer_append(&records, &encoding.type, 1);
+        buffer_append_le(&records, encoding.bytes, 2);
+        write_ops(&records, &encoding, frame,
+                  (encoding.type == STREAM_FRAME_DELTA) ? frame - VOXEL_COUNT : NULL);
+    }
+
+    buffer_t stream = { 0 };
+    buffer_append(&stream, STREAM_MAGIC, 4);
+    buffer_append_le(&stream, STREAM_VERSION, 1);
+    buffer_append_le(&stream, SIDE_LENGTH, 1);
+    buffer_append_le(&stream, anim.fps, 2);
+    buffer_append_le(&stream, anim.frame_count, 4);
+    buffer_append_le(&stream, records.size, 4);
+    buffer_append(&stream, records.data, records.size);
+    uint64_t elapsed = now_ns() - start;
+
+    uint64_t worst_ns;
+    if (!verify_stream(&stream, &anim, &worst_ns))
+        return EXIT_FAILURE;
+
+    FILE *file = fopen(output, "wb");
+    if (!file || fwrite(stream.data, 1, stream.size, file) != stream.size || fclose(file) != 0) {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+
+    size_t raw_size = (size_t) anim.frame_count * VOXEL_COUNT * 3;
+    printf("%s: %" PRIu32 " frames at %d fps, %" PRIu32 " keyframes\n",
+           output, anim.frame_count, anim.fps, keyframes);
+    printf("size: %zu bytes (raw: %zu), ratio: %.1f:1\n",
+           stream.size, raw_size, (double) raw_size / stream.size);
+    printf("worst decode: %" PRIu32 " cost units, %.0f ns on this host\n",
+           worst_cost, (double) worst_ns);
+    printf("compiled in %.1f ms\n", elapsed / 1e6);
+    if (over_budget)
+        printf("warning: %" PRIu32 " frames over the decode budget\n", over_budget);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Loopback throughput test of the DDP receiver
+ *
+ * Usage: cubebit_ddp_bench [frames] [leds] [fps]
+ *
+ * A sender thread streams frames of the given number of LEDs (split in
+ * packets of at most 480 LEDs, the last one pushed) at the given frame
+ * rate (DEFAULT_FPS; 0: as fast as possible). Every 10th frame, a packet
+ * of the previous frame is sent again and must be dropped as late.
+ * Unpaced, the sender outruns the receiver: the datagrams dropped by the
+ * kernel (full socket buffer) are reported apart from the receiver drops.
+ * The receiver runs like the "live" effect: packets are written into the
+ * back buffer of the output, and the frame is presented on its push.
+ */
+// Standard imports
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "led_strip.h"
+
+// Local imports
+#include "include/ddp.h"
+#include "include/mapping.h"
+#include "include/output.h"
+
+#define DEFAULT_FRAMES       5000
+#define DEFAULT_LEDS         512
+#define DEFAULT_FPS          1000
+#define LEDS_PER_PACKET      480
+#define RECEIVE_TIMEOUT_NS   500000000ULL  // After the last packet
+
+typedef struct {
+    uint32_t frames;
+    uint32_t leds;
+    uint32_t fps;
+    uint32_t sent;  // Datagrams sent, set by the sender
+} sender_config_t;
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static size_t build_packet(uint8_t *packet, uint8_t sequence, uint32_t first_led, uint32_t leds,
+                           bool push, uint32_t frame) {
+    uint32_t offset = first_led * 3;
+    uint16_t length = leds * 3;
+
+    packet[0] = DDP_FLAG_VERSION_1 | (push ? DDP_FLAG_PUSH : 0);
+    packet[1] = sequence;
+    packet[2] = 0x0B;  // RGB, 8 bits per channel
+    packet[3] = DDP_ID_DISPLAY;
+    packet[4] = offset >> 24;
+    packet[5] = offset >> 16;
+    packet[6] = offset >> 8;
+    packet[7] = offset;
+    packet[8] = length >> 8;
+    packet[9] = length;
+    for (uint16_t i = 0; i < length; i++)
+        packet[DDP_HEADER_SIZE + i] = frame + first_led + i;
+    return DDP_HEADER_SIZE + length;
+}
+
+
+static void *sender(void *arg) {
+    sender_config_t *config = arg;
+    static uint8_t packet[DDP_MAX_PACKET];
+    // First packet of the previous and current frames
+    static uint8_t first_packets[2][DDP_MAX_PACKET];
+    size_t first_sizes[2] = { 0 };
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in address = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(DDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    connect(sock, (struct sockaddr *) &address, sizeof(address));
+
+    uint64_t period = config->fps ? 1000000000ULL / config->fps : 0;
+    uint64_t deadline = now_ns();
+    for (uint32_t frame = 0; frame < config->frames; frame++) {
+        uint8_t sequence = frame % 15 + 1;
+
+        for (uint32_t led = 0; led < config->leds; led += LEDS_PER_PACKET) {
+            uint32_t count = MIN_(LEDS_PER_PACKET, config->leds - led);
+            size_t size = build_packet(packet, sequence, led, count,
+                                       led + count == config->leds, frame);
+            if (send(sock, packet, size, 0) == (ssize_t) size)
+                config->sent++;
+            if (led == 0) {
+                memcpy(first_packets[frame % 2], packet, size);
+                first_sizes[frame % 2] = size;
+            }
+        }
+
+        if (frame % 10 == 9) {
+            size_t size = first_sizes[(frame + 1) % 2];
+            if (send(sock, first_packets[(frame + 1) % 2], size, 0) == (ssize_t) size)
+                config->sent++;
+        }
+
+        if (period) {
+            deadline += period;
+            struct timespec ts = { .tv_sec = deadline / 1000000000ULL, .tv_nsec = deadline % 1000000000ULL };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+    close(sock);
+    return NULL;
+}
+
+
+int main(int argc, char **argv) {
+    sender_config_t config = {
+        .frames = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES,
+        .leds   = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_LEDS,
+        .fps    = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_FPS,
+    };
+    if (!config.frames || !config.leds) {
+        fprintf(stderr, "Usage: %s [frames] [leds] [fps]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    output_channel_t channels[LED_STRIP_CHANNELS];
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        channels[channel] = (output_channel_t){ .led_strip = led_strip_mock_new(LED_CHANNEL_LED_COUNT) };
+        if (!channels[channel].led_strip)
+            return EXIT_FAILURE;
+    }
+    build_pix_map(&g_cubebit_wiring);
+    output_init(channels);
+
+    ddp_receiver_t receiver;
+    if (ddp_open(&receiver, DDP_PORT) != ESP_OK)
+        return EXIT_FAILURE;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, sender, &config);
+
+    framebuffer_t *fb = output_get_back_buffer();
+    uint64_t start = now_ns();
+    uint64_t last_packet = start;
+    uint64_t worst_gap = 0, last_frame = 0;
+    while (receiver.stats.frames < config.frames && now_ns() - last_packet < RECEIVE_TIMEOUT_NS) {
+        uint32_t packets = receiver.stats.packets;
+        if (ddp_poll(&receiver, fb)) {
+            fb = output_present();
+            uint64_t now = now_ns();
+            if (last_frame)
+                worst_gap = MAX_(worst_gap, now - last_frame);
+            last_frame = now;
+        }
+        if (receiver.stats.packets != packets)
+            last_packet = now_ns();
+    }
+    uint64_t elapsed = last_frame - start;
+    output_flush();
+    pthread_join(thread, NULL);
+    while (ddp_poll(&receiver, fb))
+        ;  // Count the datagrams still queued after the last frame
+    ddp_close(&receiver);
+
+    const ddp_stats_t *stats = &receiver.stats;
+    uint32_t received = stats->packets + stats->late + stats->invalid;
+    printf("%" PRIu32 " LEDs per frame (%d on the cube), %" PRIu32 " frames at %" PRIu32 " fps (0: unpaced)\n",
+           config.leds, LED_STRIP_LED_COUNT, config.frames, config.fps);
+    printf("sent: %" PRIu32 " datagrams; lost in the socket buffer: %" PRIu32 "\n",
+           config.sent, config.sent - received);
+    printf("received: %" PRIu32 " frames (%.0f fps), %" PRIu32 " packets\n",
+           stats->frames, elapsed ? stats->frames * 1e9 / elapsed : 0., stats->packets);
+    printf("dropped: %" PRIu32 " late, %" PRIu32 " invalid; worst gap between frames: %.2f ms\n",
+           stats->late, stats->invalid, worst_gap / 1e6);
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++)
+        led_strip_del(channels[channel].led_strip);
+    return EXIT_SUCCESS;
+}
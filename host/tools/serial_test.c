@@ -0,0 +1,241 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Self-test of the serial link over a pseudo-terminal
+ *
+ * Usage: cubebit_serial_test [frames]
+ *
+ * The firmware receiver runs on the master side of a pseudo-terminal,
+ * this program plays the computer on the slave side:
+ *  - latency: round trips of echo frames
+ *  - throughput: pixel frames (raw and RLE) sent back to back, one of them
+ *    corrupted, shown like the "serial" scenario does
+ *  - the counters of the receiver, read with a stats frame
+ */
+// Standard imports
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "led_strip.h"
+#include "host_shim.h"
+
+// Local imports
+#include "include/mapping.h"
+#include "include/output.h"
+#include "include/serial_link.h"
+
+#define DEFAULT_FRAMES       5000
+#define ECHO_COUNT           200
+#define ECHO_SIZE            64
+#define CORRUPTED_FRAME      100
+#define RECEIVE_TIMEOUT_NS   1000000000ULL
+
+typedef struct {
+    int fd;
+    uint32_t frames;
+} writer_config_t;
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static void write_all(int fd, const uint8_t *data, size_t size) {
+    while (size) {
+        ssize_t ret = write(fd, data, size);
+        if (ret <= 0)
+            return;
+        data += ret;
+        size -= ret;
+    }
+}
+
+
+/**
+ * @brief Wait for a frame of the given type from the receiver
+ */
+static bool read_frame(int fd, serial_parser_t *parser, uint8_t type) {
+    serial_stats_t errors = { 0 };
+    uint8_t byte;
+
+    while (read(fd, &byte, 1) == 1) {
+        if (serial_parser_feed(parser, byte, &errors) && parser->type == type)
+            return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Pixel frames of a moving gradient; odd frames are RLE encoded
+ */
+static size_t build_pixel_frame(uint8_t *frame, uint32_t index) {
+    static uint8_t payload[SERIAL_MAX_PAYLOAD];
+    uint16_t length = 0;
+
+    if (index % 2) {
+        // Runs of 8 LEDs
+        for (uint16_t led = 0; led < LED_STRIP_LED_COUNT; led += 8) {
+            payload[length++] = 8 - 1;
+            payload[length++] = index + led;
+            payload[length++] = led;
+            payload[length++] = 255 - led;
+        }
+        return serial_encode_frame(frame, SERIAL_TYPE_PIXELS_RLE, index, payload, length);
+    }
+
+    for (uint16_t led = 0; led < LED_STRIP_LED_COUNT; led++) {
+        payload[length++] = index + led;
+        payload[length++] = led;
+        payload[length++] = 255 - led;
+    }
+    return serial_encode_frame(frame, SERIAL_TYPE_PIXELS, index, payload, length);
+}
+
+
+static void *writer(void *arg) {
+    const writer_config_t *config = arg;
+    static uint8_t frame[SERIAL_MAX_FRAME];
+
+    for (uint32_t i = 0; i < config->frames; i++) {
+        size_t size = build_pixel_frame(frame, i);
+        if (i == CORRUPTED_FRAME)
+            frame[SERIAL_HEADER_SIZE] ^= 0xFF;
+        write_all(config->fd, frame, size);
+    }
+    return NULL;
+}
+
+
+static void test_latency(int fd) {
+    static uint8_t frame[SERIAL_MAX_FRAME];
+    static uint8_t payload[SERIAL_MAX_PAYLOAD];
+    serial_parser_t parser;
+    uint64_t total = 0, worst = 0, best = UINT64_MAX;
+
+    serial_parser_init(&parser, payload);
+    for (uint16_t i = 0; i < ECHO_COUNT; i++) {
+        uint8_t data[ECHO_SIZE];
+        memset(data, i, sizeof(data));
+        size_t size = serial_encode_frame(frame, SERIAL_TYPE_ECHO, i, data, sizeof(data));
+
+        uint64_t start = now_ns();
+        write_all(fd, frame, size);
+        if (!read_frame(fd, &parser, SERIAL_TYPE_ECHO) || parser.sequence != (uint8_t) i
+            || memcmp(payload, data, sizeof(data)) != 0) {
+            printf("echo %d: bad answer\n", i);
+            return;
+        }
+        uint64_t elapsed = now_ns() - start;
+        total += elapsed;
+        worst = MAX_(worst, elapsed);
+        best = MIN_(best, elapsed);
+    }
+    printf("echo of %d bytes: round trip min %.1f us, avg %.1f us, max %.1f us\n",
+           ECHO_SIZE, best / 1e3, total / 1e3 / ECHO_COUNT, worst / 1e3);
+}
+
+
+static void print_stats(int fd) {
+    static uint8_t frame[SERIAL_MAX_FRAME];
+    static uint8_t payload[SERIAL_MAX_PAYLOAD];
+    serial_parser_t parser;
+
+    serial_parser_init(&parser, payload);
+    write_all(fd, frame, serial_encode_frame(frame, SERIAL_TYPE_STATS, 0, NULL, 0));
+    if (!read_frame(fd, &parser, SERIAL_TYPE_STATS) || parser.length < 24) {
+        printf("stats: bad answer\n");
+        return;
+    }
+
+    uint32_t counters[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        counters[i] = payload[4 * i] | (payload[4 * i + 1] << 8) | (payload[4 * i + 2] << 16)
+                    | ((uint32_t) payload[4 * i + 3] << 24);
+    }
+    printf("receiver: %" PRIu32 " frames, %" PRIu32 " shown, %" PRIu32 " overruns, "
+           "%" PRIu32 " CRC errors, %" PRIu32 " invalid, %" PRIu32 " bytes\n",
+           counters[0], counters[1], counters[2], counters[3], counters[4], counters[5]);
+}
+
+
+int main(int argc, char **argv) {
+    writer_config_t config = { .frames = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES };
+    if (config.frames <= CORRUPTED_FRAME) {
+        fprintf(stderr, "Usage: %s [frames > %d]\n", argv[0], CORRUPTED_FRAME);
+        return EXIT_FAILURE;
+    }
+
+    output_channel_t channels[LED_STRIP_CHANNELS];
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        channels[channel] = (output_channel_t){ .led_strip = led_strip_mock_new(LED_CHANNEL_LED_COUNT) };
+        if (!channels[channel].led_strip)
+            return EXIT_FAILURE;
+    }
+    build_pix_map(&g_cubebit_wiring);
+    output_init(channels);
+    serial_link_init();
+
+    config.fd = open(uart_shim_get_pty_name(SERIAL_UART_NUM), O_RDWR | O_NOCTTY);
+    struct termios attributes;
+    if (config.fd < 0 || tcgetattr(config.fd, &attributes) != 0) {
+        perror("pty");
+        return EXIT_FAILURE;
+    }
+    cfmakeraw(&attributes);
+    tcsetattr(config.fd, TCSANOW, &attributes);
+
+    test_latency(config.fd);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, writer, &config);
+
+    // Like the "serial" scenario, as fast as possible
+    framebuffer_t *fb = output_get_back_buffer();
+    serial_stats_t stats;
+    uint32_t expected = config.frames - 1;
+    uint64_t start = now_ns(), last_frame = start;
+    do {
+        if (serial_link_show(fb)) {
+            fb = output_present();
+            last_frame = now_ns();
+        }
+        serial_link_get_stats(&stats);
+    } while (stats.frames < expected && now_ns() - last_frame < RECEIVE_TIMEOUT_NS);
+    serial_link_show(fb);
+    output_present();
+    output_flush();
+    pthread_join(thread, NULL);
+
+    uint64_t elapsed = last_frame - start;
+    printf("%" PRIu32 " pixel frames of %d LEDs in %.1f ms: %.0f fps, %.2f MB/s\n",
+           stats.frames, LED_STRIP_LED_COUNT, elapsed / 1e6,
+           stats.frames * 1e9 / elapsed, stats.bytes * 1e3 / elapsed);
+    print_stats(config.fd);
+
+    close(config.fd);
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++)
+        led_strip_del(channels[channel].led_strip);
+    return stats.frames == expected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
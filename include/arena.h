@@ -0,0 +1,45 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+#include "include/commons.h"
+
+/**
+ * @brief Static memory of the effect states
+ * The arena is reset on each scenario change; nothing is freed individually
+ * and nothing comes from the heap after boot.
+ * The blocks are taken from one end of the arena, the other end being
+ * free for the next effect: during a transition, the outgoing and the
+ * incoming effects keep their states side by side (see arena_flip()).
+ * The largest states keep a few bytes per LED: the size follows the cube,
+ * on top of a few KB for the particle pools (see particles.h); the arena
+ * holds two of them. Override with -DEFFECT_ARENA_SIZE=... and check the
+ * peak usage reported by the engine.
+ */
+#ifndef EFFECT_ARENA_SIZE
+#define EFFECT_ARENA_SIZE    (2 * (4096 + LED_STRIP_LED_COUNT * 8))  // Bytes
+#endif
+
+#define ARENA_ALIGN          8
+
+void arena_reset(void);
+void arena_flip(void);
+void *arena_alloc(size_t size);
+size_t arena_used(void);
+
+#endif // __ARENA_H__
@@ -15,8 +15,8 @@
 #ifndef __BASE_H__
 #define __BASE_H__
 
-#include "led_strip.h"
+#include "include/effect.h"
 
-void base(led_strip_handle_t *led_strip);
+extern const effect_t g_base_effect;
 
 #endif // __BASE_H__
@@ -18,17 +18,44 @@
 #include <stdbool.h>
 #include <inttypes.h>
 
-#include <esp_random.h>
-
 /** User configuration variables **/
 
 #define LED_STRIP_GPIO         GPIO_NUM_8 // GPIO connected to the WS2812
-#define LED_STRIP_LED_COUNT    64         // Total number of LEDs
 
-// Set to 1 to use DMA for driving the LED strip, 0 otherwise
-// Please note the RMT DMA feature is only available on chips e.g. ESP32-S3/P4
-// => not on C6
-#define LED_STRIP_USE_DMA    0
+// Number of LEDs on each edge of the cube, up to 16 (4096 LEDs);
+// override with -DSIDE_LENGTH=...
+#ifndef SIDE_LENGTH
+#define SIDE_LENGTH            4
+#endif
+#define LED_STRIP_LED_COUNT    (SIDE_LENGTH * SIDE_LENGTH * SIDE_LENGTH) // Total number of LEDs
+
+// Data lines transmitted in parallel, one RMT channel each (the ESP32-C6 has 2).
+// Each channel drives a slice of SIDE_LENGTH / LED_STRIP_CHANNELS consecutive
+// planes, see mapping.h; list the GPIO of each one, first slice first:
+// #define LED_STRIP_CHANNELS     2
+// #define LED_STRIP_GPIOS        { GPIO_NUM_8, GPIO_NUM_7 }
+#ifndef LED_STRIP_CHANNELS
+#define LED_STRIP_CHANNELS     1
+#define LED_STRIP_GPIOS        { LED_STRIP_GPIO }
+#endif
+#define LED_CHANNEL_LED_COUNT  (LED_STRIP_LED_COUNT / LED_STRIP_CHANNELS) // LEDs per data line
+
+// Rotation of the cube on its base, if it isn't mounted as wired:
+// -DCUBE_MOUNT_ROTATION=<0..23> (see view.h)
+
+// The strips are driven by the RMT or the SPI peripheral, chosen at boot from
+// the settings (see led_backend.h). Build with LED_BENCHMARK to measure the
+// refreshes on both backends at boot:
+// #define LED_BENCHMARK
+
+// Wi-Fi station credentials (build flags); the network receiver
+// ("live" scenario, see ddp.h) is only built if they are set
+// #define WIFI_SSID        "ssid"
+// #define WIFI_PASSWORD    "password"
+
+// Receive pixel streams from a computer over the USB-Serial-JTAG, or the
+// UART SERIAL_UART_NUM ("serial" scenario, see serial_proto.h)
+// #define SERIAL_STREAMING
 
 /** Misc **/
 #define MAX_(a, b)    (((a) > (b)) ? (a) : (b))
@@ -40,19 +67,16 @@ typedef struct {
     uint8_t blue;
 } color_t;
 
-uint8_t get_pix_id(uint8_t x, uint8_t y, uint8_t z);
-
 /** Global settings **/
-#define SIDE_LENGTH    4
+_Static_assert(SIDE_LENGTH >= 2 && SIDE_LENGTH <= 16, "SIDE_LENGTH must be in [2;16]");
+_Static_assert(SIDE_LENGTH % LED_STRIP_CHANNELS == 0, "Channels must drive whole planes");
 
-extern uint8_t g_side2;
-extern uint8_t g_side3;
+// Index of a LED in the strip
+typedef uint16_t pix_id_t;
 
-extern bool g_button_pressed;
+extern uint16_t g_side2;
+extern uint16_t g_side3;
 
-// 2D
-// uint8_t g_cube[SIDE_LENGTH][SIDE_LENGTH];
-// 3D
-extern uint8_t g_cube[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];
+extern volatile bool g_button_pressed;
 
 #endif // __COMMON_H__
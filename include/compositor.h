@@ -0,0 +1,55 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __COMPOSITOR_H__
+#define __COMPOSITOR_H__
+
+#include <stdint.h>
+
+#include "include/commons.h"
+#include "include/framebuffer.h"
+
+/**
+ * @brief Stack of framebuffers blended into one frame
+ *
+ * Layers are blended bottom first, over black. The kernels work on the
+ * pixels as packed 32-bit words of 4 channel bytes (SWAR): the modes treat
+ * every channel alike, so the words don't need to be aligned on pixels.
+ * Nothing is done if no visible layer changed since the last composition.
+ */
+typedef enum {
+    BLEND_ALPHA,     // Mix with the layers below by the opacity
+    BLEND_ADD,       // Saturating sum
+    BLEND_MULTIPLY,  // Darken the layers below (filters, masks)
+    BLEND_MAX,       // Lightest of each channel
+} blend_mode_t;
+
+typedef struct {
+    framebuffer_t fb;  // Rendered by the owner of the layer
+    blend_mode_t mode;
+    uint8_t opacity;   // 0: hidden, 255: opaque
+} layer_t;
+
+typedef struct {
+    layer_t *layers;   // Bottom first
+    uint8_t count;
+    bool stale;        // Settings changed: compose again
+} compositor_t;
+
+void compositor_init(compositor_t *compositor, layer_t *layers, uint8_t count);
+void compositor_set_layer(compositor_t *compositor, uint8_t index, blend_mode_t mode, uint8_t opacity);
+bool compositor_render(compositor_t *compositor, framebuffer_t *out);
+void blend_pixels(color_t *dst, const color_t *src, uint16_t count, blend_mode_t mode, uint8_t opacity);
+
+#endif // __COMPOSITOR_H__
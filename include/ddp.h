@@ -0,0 +1,70 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __DDP_H__
+#define __DDP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "include/framebuffer.h"
+
+/**
+ * @brief Receiver of the Distributed Display Protocol (DDP) over UDP
+ *
+ * Header (big-endian): flags, sequence (low nibble, 0: unused), data type,
+ * destination id, data offset (32 bits, in bytes), data length (16 bits),
+ * then an optional timecode (if DDP_FLAG_TIMECODE).
+ * The data is RGB, in strip order from the offset.
+ */
+#define DDP_PORT              4048
+#define DDP_HEADER_SIZE       10
+#define DDP_TIMECODE_SIZE     4
+// Largest UDP payload in a 1500 bytes MTU
+#define DDP_MAX_PACKET        1472
+
+#define DDP_FLAG_VERSION_MASK 0xC0
+#define DDP_FLAG_VERSION_1    0x40
+#define DDP_FLAG_TIMECODE     0x10
+#define DDP_FLAG_PUSH         0x01
+
+#define DDP_ID_DISPLAY        1
+
+#ifndef DDP_BIND_ADDRESS
+#define DDP_BIND_ADDRESS      INADDR_ANY
+#endif
+
+typedef struct {
+    uint32_t packets;   // Valid packets
+    uint32_t frames;    // Pushed frames
+    uint32_t late;      // Packets dropped: sequence older than the current frame
+    uint32_t invalid;   // Packets dropped: malformed or not for us
+    uint32_t ignored;   // Bytes beyond the LEDs of the cube
+} ddp_stats_t;
+
+typedef struct {
+    int socket;
+    uint8_t sequence;   // Of the current frame, 0 if none
+    ddp_stats_t stats;
+} ddp_receiver_t;
+
+esp_err_t ddp_open(ddp_receiver_t *receiver, uint16_t port);
+void ddp_close(ddp_receiver_t *receiver);
+bool ddp_handle_packet(ddp_receiver_t *receiver, const uint8_t *packet, size_t size,
+                       framebuffer_t *fb);
+bool ddp_poll(ddp_receiver_t *receiver, framebuffer_t *fb);
+
+#endif // __DDP_H__
@@ -0,0 +1,46 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __EFFECT_H__
+#define __EFFECT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "include/framebuffer.h"
+#include "include/view.h"
+
+/**
+ * @brief Descriptor of an effect, driven by the engine (see engine.c)
+ *
+ * Effects are pure frame producers: they don't wait, don't poll the button
+ * and don't talk to the strip. Their working data lives in a state block
+ * of state_size bytes, carved (zeroed) by the engine from a static
+ * arena (see arena.h).
+ */
+typedef struct {
+    const char *name;
+    uint16_t fps;          // Target frame rate
+    size_t state_size;
+    const void *config;    // Passed to init(): several descriptors can share the code
+    const view_t *view;    // Optional, rotation/mirror/scroll of the frames on the cube
+    // Optional, called once with a zeroed state and a cleared framebuffer
+    void (*init)(void *state, const void *config);
+    // Render the next frame; dt_ms: time elapsed since the previous step
+    void (*step)(void *state, uint32_t dt_ms, framebuffer_t *fb);
+    // Optional
+    void (*teardown)(void *state);
+} effect_t;
+
+#endif // __EFFECT_H__
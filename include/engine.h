@@ -0,0 +1,66 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+#include "include/effect.h"
+#include "include/input.h"
+#include "include/transition.h"
+
+#define ENGINE_TIME_SCALE_NORMAL    100  // Percents
+
+// Scenario changes: the outgoing effect keeps running while it fades out
+#ifndef ENGINE_TRANSITION
+#define ENGINE_TRANSITION           TRANSITION_CROSSFADE
+#endif
+#define ENGINE_TRANSITION_MS        600
+
+/**
+ * @brief Memory used by an effect while it ran
+ */
+typedef struct {
+    size_t arena_used;        // Bytes of the state arena
+    uint32_t heap_peak;       // Heap taken from the start of the effect (sampled once per frame)
+    uint32_t stack_free_min;  // Stack high water mark of the rendering task (since boot)
+} engine_usage_t;
+
+/**
+ * @brief Two effects running at once during a scenario change, see engine_run()
+ */
+typedef struct {
+    const effect_t *from;  // Outgoing effect
+    void *from_state;
+    const effect_t *to;    // Incoming effect
+    void *to_state;
+    uint32_t elapsed_ms;   // Since the start of the transition
+    uint32_t from_ms;      // Since the last step of each effect
+    uint32_t to_ms;
+    bool to_started;
+} engine_transition_t;
+
+void engine_set_time_scale(uint16_t percent);
+void engine_set_transition(transition_type_t type, uint16_t duration_ms);
+void *engine_begin(const effect_t *effect, framebuffer_t *fb);
+void engine_sample_usage(void);
+void engine_end(const effect_t *effect, void *state, engine_usage_t *usage);
+void *engine_transition_begin(engine_transition_t *transition, const effect_t *from, void *from_state,
+                              const effect_t *to, framebuffer_t *fb);
+void engine_transition_step(engine_transition_t *transition);
+void engine_transition_blend(const engine_transition_t *transition, framebuffer_t *fb);
+bool engine_transition_advance(engine_transition_t *transition, uint32_t dt_ms);
+uint32_t engine_transition_end(engine_transition_t *transition, framebuffer_t *fb);
+input_event_t engine_run(const effect_t *effect);
+
+#endif // __ENGINE_H__
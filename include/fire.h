@@ -15,8 +15,9 @@
 #ifndef __FIRE_H__
 #define __FIRE_H__
 
-#include "led_strip.h"
+#include "include/effect.h"
 
-void fire(led_strip_handle_t *led_strip, bool red_flames);
+extern const effect_t g_red_fire_effect;
+extern const effect_t g_green_fire_effect;
 
 #endif // __FIRE_H__
@@ -0,0 +1,38 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __FRAME_CLOCK_H__
+#define __FRAME_CLOCK_H__
+
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @brief Fixed-rate frame scheduler
+ * Deadlines are computed from the start of the animation, not from the
+ * end of the previous frame, so the frame rate doesn't drift.
+ * Waits are aborted by a notification of the rendering task.
+ */
+typedef struct {
+    TickType_t period;     // Duration of a frame
+    TickType_t last_wake;  // Start of the current frame slot
+    uint32_t frames;       // Frames rendered
+    uint32_t missed;       // Frames finished after their deadline
+    uint32_t skipped;      // Frame slots dropped to get back on schedule
+} frame_clock_t;
+
+void frame_clock_init(frame_clock_t *clock, uint16_t fps);
+uint32_t frame_clock_wait(frame_clock_t *clock);
+void frame_clock_log_stats(const frame_clock_t *clock, const char *tag);
+
+#endif // __FRAME_CLOCK_H__
@@ -0,0 +1,43 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __FRAME_TX_H__
+#define __FRAME_TX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "include/strip_stream.h"
+
+/**
+ * @brief Transmitter of whole frames on a data line, without pixel buffer
+ *
+ * Unlike the led_strip driver, the frame isn't copied LED by LED into the
+ * driver: the custom RMT encoder pulls the bytes of a strip_stream_t while
+ * the frame is on the wire, FRAME_TX_CHUNK_SIZE bytes at a time, as the
+ * halves of the RMT memory (ping-pong) are freed.
+ * The stream and its framebuffer must stay untouched until frame_tx_wait_done().
+ */
+#define FRAME_TX_CHUNK_SIZE    24  // Bytes converted at once, 8 LEDs
+
+typedef struct frame_tx_t *frame_tx_handle_t;
+
+esp_err_t frame_tx_new_rmt(int gpio_num, bool with_dma, frame_tx_handle_t *tx);
+esp_err_t frame_tx_transmit(frame_tx_handle_t tx, strip_stream_t *stream);
+esp_err_t frame_tx_wait_done(frame_tx_handle_t tx, int64_t *done_us);
+esp_err_t frame_tx_del(frame_tx_handle_t tx);
+
+#endif // __FRAME_TX_H__
@@ -0,0 +1,78 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __FRAMEBUFFER_H__
+#define __FRAMEBUFFER_H__
+
+#include <string.h>  // memset
+
+#include "include/commons.h"
+
+// Linear light emitted for each (gamma corrected) value, 65535: full duty cycle.
+// Built by output_init().
+extern uint16_t g_light_levels[256];
+
+/**
+ * @brief One frame of the cube, in (x,y,z) order
+ * The mapping to the strip order is done when the frame is transmitted.
+ * The light of each channel is summed as the pixels change, to estimate
+ * the current drawn by the frame without scanning it.
+ */
+typedef struct {
+    color_t pixels[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];
+    uint32_t light[3];  // Sum of the light levels of the pixels: red, green, blue
+    bool dirty;         // Modified since the last presented frame
+} framebuffer_t;
+
+/**
+ * @brief Write a pixel given by its address in fb->pixels
+ */
+static inline void fb_write(framebuffer_t *fb, color_t *pixel, color_t color) {
+    if (pixel->red == color.red && pixel->green == color.green && pixel->blue == color.blue)
+        return;
+
+    fb->light[0] += g_light_levels[color.red] - g_light_levels[pixel->red];
+    fb->light[1] += g_light_levels[color.green] - g_light_levels[pixel->green];
+    fb->light[2] += g_light_levels[color.blue] - g_light_levels[pixel->blue];
+    *pixel = color;
+    fb->dirty = true;
+}
+
+static inline void fb_set_pixel(framebuffer_t *fb, uint8_t x, uint8_t y, uint8_t z, color_t color) {
+    fb_write(fb, &fb->pixels[x][y][z], color);
+}
+
+/**
+ * @brief Rebuild the light sums after a direct write of fb->pixels (bulk copies)
+ */
+static inline void fb_recount(framebuffer_t *fb) {
+    const color_t *pixel = &fb->pixels[0][0][0];
+    uint32_t light[3] = { 0, 0, 0 };
+
+    for (uint16_t i = 0; i < LED_STRIP_LED_COUNT; i++, pixel++) {
+        light[0] += g_light_levels[pixel->red];
+        light[1] += g_light_levels[pixel->green];
+        light[2] += g_light_levels[pixel->blue];
+    }
+    memcpy(fb->light, light, sizeof(light));
+    fb->dirty = true;
+}
+
+static inline void fb_clear(framebuffer_t *fb) {
+    memset(fb->pixels, 0, sizeof(fb->pixels));
+    memset(fb->light, 0, sizeof(fb->light));
+    fb->dirty = true;
+}
+
+#endif // __FRAMEBUFFER_H__
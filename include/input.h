@@ -0,0 +1,40 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __INPUT_H__
+#define __INPUT_H__
+
+#include <stdbool.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define INPUT_TASK_PRIORITY      (configMAX_PRIORITIES - 3)
+#define INPUT_TASK_STACK_SIZE    2048
+
+#define INPUT_DEBOUNCE_MS        30    // The line must be stable this long
+#define INPUT_LONG_PRESS_MS      1000  // Held longer: long press
+
+typedef enum {
+    INPUT_EVENT_NONE,
+    INPUT_EVENT_SHORT_PRESS,  // Sent on release
+    INPUT_EVENT_LONG_PRESS,   // Sent while still held
+} input_event_t;
+
+void input_init(TaskHandle_t render_task);
+void input_edge_from_isr(bool pressed);
+void input_post_event(input_event_t event);
+input_event_t input_take_event(void);
+
+#endif // __INPUT_H__
@@ -0,0 +1,65 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __LED_BACKEND_H__
+#define __LED_BACKEND_H__
+
+#include "led_strip.h"
+
+#include "include/commons.h"
+#include "include/output.h"
+
+/**
+ * @brief Peripheral generating the signal of the strips
+ *
+ * The backend is read from the NVS at boot (namespace LED_BACKEND_NVS_NAMESPACE,
+ * u8 key LED_BACKEND_NVS_KEY), LED_BACKEND_DEFAULT if not set.
+ * All of them give output channels: the output doesn't know which one is in use.
+ *  - RMT: one TX channel per strip, the bits are encoded on the fly by an ISR.
+ *  - SPI: the frame is encoded in a buffer sent by the DMA. There is only one
+ *    SPI bus available: it drives the first channel, the others stay on RMT.
+ *  - RMT direct: like RMT, but the ISR encodes the pixels straight from the
+ *    framebuffer (see frame_tx.h): no pixel buffer nor led_strip calls.
+ */
+typedef enum {
+    LED_BACKEND_RMT,
+    LED_BACKEND_SPI,
+    LED_BACKEND_RMT_DIRECT,
+    LED_BACKEND_MAX,
+} led_backend_t;
+
+#ifndef LED_BACKEND_DEFAULT
+#define LED_BACKEND_DEFAULT          LED_BACKEND_RMT_DIRECT
+#endif
+#define LED_BACKEND_NVS_NAMESPACE    "cubebit"
+#define LED_BACKEND_NVS_KEY          "led_backend"
+
+// Frames pushed on each backend by led_backend_benchmark()
+#define LED_BACKEND_BENCH_FRAMES     200
+
+typedef struct {
+    uint32_t latency_us;   // From the trigger to the end of the transmission of all the channels
+    uint32_t call_us;      // Spent starting the transmission
+    uint8_t cpu_busy;      // Share of the CPU taken by the driver during the transmission, %
+    uint32_t max_fps;      // Back to back refreshes
+} led_backend_bench_t;
+
+const char *led_backend_name(led_backend_t backend);
+led_backend_t led_backend_load(void);
+esp_err_t led_backend_save(led_backend_t backend);
+void led_backend_create(led_backend_t backend, output_channel_t channels[LED_STRIP_CHANNELS]);
+void led_backend_delete(output_channel_t channels[LED_STRIP_CHANNELS]);
+void led_backend_benchmark(led_backend_t backend, uint16_t frames, led_backend_bench_t *result);
+
+#endif // __LED_BACKEND_H__
@@ -0,0 +1,94 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __MAPPING_H__
+#define __MAPPING_H__
+
+#include "include/commons.h"
+
+/**
+ * @brief Wiring of the LEDs inside one horizontal plane
+ *
+ * The strip runs along lines parallel to line_axis; the lines are then
+ * stacked along the other axis of the plane.
+ */
+typedef struct {
+    uint8_t line_axis;    // Axis followed by a line of LEDs: AXIS_X or AXIS_Y
+    bool line_reversed;   // The first line runs towards the lower coordinates
+    bool stack_reversed;  // Lines are stacked towards the lower coordinates
+} plane_wiring_t;
+
+/**
+ * @brief Description of the path followed by the strip across the cube
+ * Planes are stacked along z; even and odd planes may be wired differently.
+ */
+typedef struct {
+    plane_wiring_t even_plane;
+    plane_wiring_t odd_plane;
+    bool serpentine;  // Zig-zag: every other line runs backwards
+    bool flip_x;
+    bool flip_y;
+    bool flip_z;
+} cube_wiring_t;
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t z;
+} voxel_t;
+
+enum axis { AXIS_X, AXIS_Y, AXIS_Z };
+
+// Wiring of the Cube:bit from 4tronix
+extern const cube_wiring_t g_cubebit_wiring;
+
+// (x,y,z) to the index in the led strip
+extern pix_id_t g_pix_map[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];
+// Index in the led strip to (x,y,z)
+extern voxel_t g_voxel_map[LED_STRIP_LED_COUNT];
+// Index in the led strip to the (x,y,z) of the framebuffer it shows:
+// g_voxel_map through the current view (see view.h). Read by the output.
+extern voxel_t g_frame_map[LED_STRIP_LED_COUNT];
+
+/*
+ * With several channels (LED_STRIP_CHANNELS), each strip starts on the first
+ * plane of its slice and is wired like the first planes of the cube.
+ * The strip indexes follow the channels: channel 0 has the first
+ * LED_CHANNEL_LED_COUNT indexes, and so on.
+ */
+
+void build_pix_map(const cube_wiring_t *wiring);
+
+/**
+ * @brief Convert (x,y,z) coords to the real index in the led strip
+ */
+static inline pix_id_t get_pix_id(uint8_t x, uint8_t y, uint8_t z) {
+    return g_pix_map[x][y][z];
+}
+
+/**
+ * @brief Channel driving the LED of the given strip index
+ */
+static inline uint8_t get_pix_channel(pix_id_t id) {
+    return id / LED_CHANNEL_LED_COUNT;
+}
+
+/**
+ * @brief Index of the LED in the strip of its channel
+ */
+static inline pix_id_t get_channel_index(pix_id_t id) {
+    return id % LED_CHANNEL_LED_COUNT;
+}
+
+#endif // __MAPPING_H__
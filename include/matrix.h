@@ -15,8 +15,9 @@
 #ifndef __MATRIX_H__
 #define __MATRIX_H__
 
-#include "led_strip.h"
+#include "include/effect.h"
 
-void matrix(led_strip_handle_t *led_strip);
+extern const effect_t g_matrix_effect;
+extern const effect_t g_matrix_side_effect;
 
 #endif // __MATRIX_H__
@@ -0,0 +1,82 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __OUTPUT_H__
+#define __OUTPUT_H__
+
+#include "led_strip.h"
+
+#include "include/framebuffer.h"
+#include "include/frame_tx.h"
+
+// The transmit task must preempt the rendering as soon as a frame is ready
+#define OUTPUT_TASK_PRIORITY      (configMAX_PRIORITIES - 2)
+#define OUTPUT_TASK_STACK_SIZE    3072
+
+// Correction applied to the framebuffer values on their way to the strip
+#ifndef OUTPUT_GAMMA
+#define OUTPUT_GAMMA                 2.2f
+#endif
+#define OUTPUT_BRIGHTNESS_DEFAULT    255
+// Below this frame rate, temporal dithering would flicker: the values are rounded
+#define OUTPUT_DITHER_MIN_FPS        40
+
+// Current drawn by one LED, in uA: per channel at full duty cycle, and when off
+#define OUTPUT_RED_UA                12500
+#define OUTPUT_GREEN_UA              12500
+#define OUTPUT_BLUE_UA               12500
+#define OUTPUT_IDLE_UA               1000
+// Frames estimated above this budget are dimmed to fit in it
+#ifndef OUTPUT_CURRENT_BUDGET_MA
+#define OUTPUT_CURRENT_BUDGET_MA     2000
+#endif
+// Bigger cubes need a bigger supply: the idle current alone can't be dimmed
+_Static_assert(OUTPUT_CURRENT_BUDGET_MA * 1000ULL > LED_STRIP_LED_COUNT * OUTPUT_IDLE_UA,
+               "OUTPUT_CURRENT_BUDGET_MA is below the idle current of the cube");
+
+typedef struct {
+    uint32_t transmitted;  // Frames sent to the strip
+    uint32_t unchanged;    // Presented frames not sent because nothing changed
+    uint32_t dithered;     // Unchanged frames sent again for the temporal dithering
+    uint32_t current_ma;   // Estimated current of the last presented frame, before limiting
+    uint32_t peak_ma;      // Highest estimate
+    uint32_t limited;      // Frames dimmed to fit in the current budget
+    // From the trigger to the end of the transmission, per channel: time stamped
+    // by the ISR for a frame_tx; a led_strip channel is awaited in order, its time
+    // is an upper bound that may include the wait for the previous channels
+    uint32_t transmit_us[LED_STRIP_CHANNELS];       // Last frame
+    uint32_t transmit_peak_us[LED_STRIP_CHANNELS];  // Slowest frame
+} output_stats_t;
+
+/**
+ * @brief Driver of a data line: set one of them
+ */
+typedef struct {
+    led_strip_handle_t led_strip;  // The pixels are copied into the driver
+    frame_tx_handle_t frame_tx;    // The pixels are read from the framebuffer while transmitted
+} output_channel_t;
+
+void output_init(const output_channel_t channels[LED_STRIP_CHANNELS]);
+void output_set_brightness(uint8_t brightness);
+void output_set_dithering(bool enabled);
+void output_reset_dithering(void);
+void output_set_current_budget(uint32_t budget_ma);
+framebuffer_t *output_get_back_buffer(void);
+framebuffer_t *output_present(void);
+void output_flush(void);
+void output_get_stats(output_stats_t *stats);
+void output_reset_stats(void);
+void output_log_stats(void);
+
+#endif // __OUTPUT_H__
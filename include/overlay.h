@@ -0,0 +1,46 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __OVERLAY_H__
+#define __OVERLAY_H__
+
+#include "include/effect.h"
+#include "include/compositor.h"
+
+// Effects stacked by a single overlay
+#define OVERLAY_MAX_LAYERS    4
+
+typedef struct {
+    const effect_t *effect;
+    blend_mode_t mode;
+    uint8_t opacity;  // 0: hidden, 255: opaque
+} overlay_layer_t;
+
+/**
+ * @brief Configuration of an overlay: effects drawn on top of each other
+ * Each effect runs at its own frame rate in its own layer; the views of
+ * the effects are ignored.
+ */
+typedef struct {
+    const overlay_layer_t *layers;  // Bottom first
+    uint8_t count;
+} overlay_config_t;
+
+void overlay_init(void *state, const void *config);
+void overlay_step(void *state, uint32_t dt_ms, framebuffer_t *fb);
+void overlay_teardown(void *state);
+
+extern const effect_t g_matrix_rainbow_effect;
+
+#endif // __OVERLAY_H__
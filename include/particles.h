@@ -0,0 +1,82 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __PARTICLES_H__
+#define __PARTICLES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "include/commons.h"
+#include "include/framebuffer.h"
+#include "include/prng.h"
+
+/**
+ * @brief Fixed-capacity pool of point particles
+ *
+ * The pool is a structure of arrays, kept in the state of the effect (no heap):
+ * the update walks each attribute as a flat array. Free slots are chained
+ * in a free list: spawning and killing a particle is O(1).
+ * Positions are in Q8 voxel units (voxel (x,y,z) is at x << 8, ...),
+ * velocities in Q8 voxels per second.
+ */
+#ifndef PARTICLE_CAPACITY
+#define PARTICLE_CAPACITY    MIN_(512, MAX_(128, LED_STRIP_LED_COUNT / 4))
+#endif
+#define PARTICLE_NONE        0xFFFF  // No free slot
+
+_Static_assert(PARTICLE_CAPACITY < PARTICLE_NONE, "Particle indexes are 16 bits");
+
+typedef struct {
+    int16_t x[PARTICLE_CAPACITY];   // Position, Q8
+    int16_t y[PARTICLE_CAPACITY];
+    int16_t z[PARTICLE_CAPACITY];
+    int16_t vx[PARTICLE_CAPACITY];  // Velocity, Q8 per second
+    int16_t vy[PARTICLE_CAPACITY];
+    int16_t vz[PARTICLE_CAPACITY];
+    uint16_t life[PARTICLE_CAPACITY];  // Remaining lifetime (ms), 0: free slot
+    uint16_t ttl[PARTICLE_CAPACITY];   // Lifetime at spawn (ms)
+    color_t color[PARTICLE_CAPACITY];
+    uint16_t next_free[PARTICLE_CAPACITY];
+    uint16_t free_head;
+    uint16_t count;    // Live particles
+    int16_t gravity;   // Acceleration along Z, Q8 per second²
+    bool fade;         // Dim the particles as they age
+} particle_pool_t;
+
+/**
+ * @brief Source of particles
+ * Every attribute gets a uniform random offset in [-spread; spread].
+ */
+typedef struct {
+    int16_t position[3];     // Q8
+    int16_t position_spread;
+    int16_t velocity[3];     // Q8 per second
+    int16_t velocity_spread;
+    uint16_t life_ms;
+    uint16_t life_spread_ms;
+    color_t color;
+    uint16_t rate;           // Particles per second, see particle_emit()
+    uint32_t pending;        // Fraction of particle carried over to the next call, ms * rate
+} particle_emitter_t;
+
+void particle_pool_init(particle_pool_t *pool, int16_t gravity, bool fade);
+uint16_t particle_spawn(particle_pool_t *pool);
+void particle_kill(particle_pool_t *pool, uint16_t index);
+uint16_t particle_burst(particle_pool_t *pool, const particle_emitter_t *emitter, prng_t *rng, uint16_t count);
+uint16_t particle_emit(particle_pool_t *pool, particle_emitter_t *emitter, prng_t *rng, uint32_t dt_ms);
+void particle_update(particle_pool_t *pool, uint32_t dt_ms);
+void particle_splat(const particle_pool_t *pool, framebuffer_t *fb);
+
+#endif // __PARTICLES_H__
@@ -0,0 +1,91 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __PRNG_H__
+#define __PRNG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief xoshiro128++ generator
+ * Only 32-bit operations: fast on the RISC-V cores of the C6/C3.
+ * Each effect owns its instance, there is no shared state.
+ */
+typedef struct {
+    uint32_t state[4];
+} prng_t;
+
+// Seed of all the generators; 0: seed them from the hardware RNG
+#define PRNG_RANDOM_SEED    0
+
+// Build with -DPRNG_SEED=<value> to get the same frames on every boot
+#ifndef PRNG_SEED
+#define PRNG_SEED    PRNG_RANDOM_SEED
+#endif
+
+extern uint32_t g_prng_seed;
+
+void prng_seed(prng_t *rng, uint32_t seed);
+void prng_init(prng_t *rng);
+void prng_fill(prng_t *rng, void *buffer, size_t size);
+
+static inline uint32_t prng_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+/**
+ * @brief Get the next 32 random bits
+ */
+static inline uint32_t prng_next(prng_t *rng) {
+    uint32_t *s = rng->state;
+    uint32_t result = prng_rotl(s[0] + s[3], 7) + s[0];
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = prng_rotl(s[3], 11);
+    return result;
+}
+
+/**
+ * @brief Get an unbiased random number in [0; bound[
+ * Lemire's multiply-shift method: no division in the common case.
+ */
+static inline uint32_t prng_below(prng_t *rng, uint32_t bound) {
+    uint64_t m = (uint64_t) prng_next(rng) * bound;
+    uint32_t low = (uint32_t) m;
+
+    if (low < bound) {
+        // Reject the values of the incomplete last interval
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = (uint64_t) prng_next(rng) * bound;
+            low = (uint32_t) m;
+        }
+    }
+    return m >> 32;
+}
+
+/**
+ * @brief Get an unbiased random number in [min; max]
+ */
+static inline uint32_t prng_range(prng_t *rng, uint32_t min, uint32_t max) {
+    return min + prng_below(rng, max - min + 1);
+}
+
+#endif // __PRNG_H__
@@ -15,8 +15,8 @@
 #ifndef __RAINBOW_H__
 #define __RAINBOW_H__
 
-#include "led_strip.h"
+#include "include/effect.h"
 
-void rainbow(led_strip_handle_t *led_strip);
+extern const effect_t g_rainbow_effect;
 
 #endif // __RAINBOW_H__
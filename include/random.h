@@ -15,8 +15,8 @@
 #ifndef __RANDOM_H__
 #define __RANDOM_H__
 
-#include "led_strip.h"
+#include "include/effect.h"
 
-void randomisation(led_strip_handle_t *led_strip);
+extern const effect_t g_random_effect;
 
 #endif // __RANDOM_H__
@@ -0,0 +1,100 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __SDF_H__
+#define __SDF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "include/commons.h"
+#include "include/framebuffer.h"
+
+/**
+ * @brief Volumetric rasterizer of signed distance functions (SDF)
+ *
+ * The shapes are evaluated at the centre of every voxel of the framebuffer,
+ * in fixed point only (the C6 has no FPU):
+ *  - positions and distances: Q8 voxel units (voxel (x,y,z) is at x << 8, ...);
+ *  - rotations: Q14.
+ * Positions and sizes must stay within 32 voxels of the cube, so that the
+ * squared distances fit in 32 bits.
+ * Distances are negative inside the shapes and saturated to ±SDF_DIST_MAX:
+ * only the sign and the first voxels around the surfaces matter, for the
+ * boolean operations and the anti-aliasing.
+ */
+#define SDF_ONE         (1 << 8)   // One voxel, Q8
+#define SDF_UNIT        (1 << 14)  // 1.0 in the rotation matrices, Q14
+#define SDF_DIST_MAX    (4 * SDF_ONE)
+
+typedef enum {
+    SDF_SPHERE,   // size[0]: radius
+    SDF_BOX,      // size[]: half extents along the local axes
+    SDF_PLANE,    // Half-space below the local XY plane
+    SDF_CAPSULE,  // Line of thickness size[0], from the origin to size[1] along the local Z axis
+} sdf_type_t;
+
+// Combination of a shape with the result of the shapes before it
+typedef enum {
+    SDF_UNION,
+    SDF_INTERSECT,
+    SDF_SUBTRACT,  // Carve the shape out of the previous ones
+} sdf_op_t;
+
+// Blending of the shaded shapes with the pixels of the framebuffer
+typedef enum {
+    SDF_BLEND_REPLACE,
+    SDF_BLEND_MAX,
+} sdf_blend_t;
+
+/**
+ * @brief Placement of a shape: local = m * (world - origin)
+ * The rows of m are the local axes in world coordinates.
+ */
+typedef struct {
+    int32_t m[3][3];    // Q14
+    int32_t origin[3];  // Q8
+} sdf_transform_t;
+
+typedef struct {
+    sdf_type_t type;
+    sdf_op_t op;
+    sdf_transform_t transform;
+    int32_t size[3];    // Q8, see sdf_type_t
+} sdf_shape_t;
+
+/**
+ * @brief Distance to the surface of each voxel, (x,y,z) order like the framebuffer
+ */
+typedef struct {
+    int16_t d[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];  // Q8
+} sdf_field_t;
+
+int16_t sdf_sin(uint8_t angle);
+int16_t sdf_cos(uint8_t angle);
+uint32_t sdf_isqrt(uint32_t value);
+
+void sdf_identity(sdf_transform_t *transform, const int32_t origin[3]);
+void sdf_orient(sdf_transform_t *transform, uint8_t yaw, uint8_t pitch, uint8_t roll);
+void sdf_align(sdf_transform_t *transform, const int32_t direction[3]);
+
+void sdf_sphere(sdf_shape_t *shape, sdf_op_t op, const int32_t center[3], int32_t radius);
+void sdf_box(sdf_shape_t *shape, sdf_op_t op, const int32_t center[3], const int32_t half[3]);
+void sdf_plane(sdf_shape_t *shape, sdf_op_t op, const int32_t point[3], const int32_t normal[3]);
+void sdf_line(sdf_shape_t *shape, sdf_op_t op, const int32_t from[3], const int32_t to[3], int32_t radius);
+
+void sdf_render(sdf_field_t *field, const sdf_shape_t *shapes, size_t count);
+void sdf_shade(const sdf_field_t *field, color_t color, sdf_blend_t blend, framebuffer_t *fb);
+
+#endif // __SDF_H__
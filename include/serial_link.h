@@ -0,0 +1,33 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __SERIAL_LINK_H__
+#define __SERIAL_LINK_H__
+
+#include "include/framebuffer.h"
+#include "include/serial_proto.h"
+
+// Port of the pixel streams (build flags): a UART number (SERIAL_UART_NUM),
+// otherwise the USB-Serial-JTAG of the chip
+#define SERIAL_BAUD_RATE            2000000
+#define SERIAL_RX_BUFFER_SIZE       (2 * SERIAL_MAX_FRAME)
+#define SERIAL_TX_BUFFER_SIZE       (2 * SERIAL_MAX_FRAME)
+#define SERIAL_TASK_PRIORITY        (configMAX_PRIORITIES - 3)
+#define SERIAL_TASK_STACK_SIZE      3072
+
+void serial_link_init(void);
+bool serial_link_show(framebuffer_t *fb);
+void serial_link_get_stats(serial_stats_t *stats);
+
+#endif // __SERIAL_LINK_H__
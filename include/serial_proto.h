@@ -0,0 +1,87 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __SERIAL_PROTO_H__
+#define __SERIAL_PROTO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "include/framebuffer.h"
+
+/**
+ * @brief Framing of the pixel streams sent over a serial link
+ *
+ * Frame: sync (0xCB 0x3D), type, sequence, payload length (16 bits LE),
+ * payload, CRC-16/CCITT (LE) of the type, sequence, length and payload.
+ *
+ * Payloads, in strip order:
+ *  - SERIAL_TYPE_PIXELS: r, g, b per LED
+ *  - SERIAL_TYPE_PIXELS_RLE: runs of (count - 1, r, g, b)
+ *  - SERIAL_TYPE_ECHO: any data, sent back as is (latency self-test)
+ *  - SERIAL_TYPE_STATS: empty; answered with the counters of the receiver
+ *    (serial_stats_t, 32 bits LE each)
+ */
+#define SERIAL_SYNC_1               0xCB
+#define SERIAL_SYNC_2               0x3D
+#define SERIAL_HEADER_SIZE          6
+#define SERIAL_CRC_SIZE             2
+// RLE worst case: 4 bytes per LED
+#define SERIAL_MAX_PAYLOAD          (LED_STRIP_LED_COUNT * 4)
+#define SERIAL_MAX_FRAME            (SERIAL_HEADER_SIZE + SERIAL_MAX_PAYLOAD + SERIAL_CRC_SIZE)
+
+#define SERIAL_TYPE_PIXELS          1
+#define SERIAL_TYPE_PIXELS_RLE      2
+#define SERIAL_TYPE_ECHO            3
+#define SERIAL_TYPE_STATS           4
+
+typedef struct {
+    uint32_t frames;     // Pixel frames received
+    uint32_t shown;      // Pixel frames decoded into the framebuffer
+    uint32_t overruns;   // Pixel frames replaced before being shown
+    uint32_t crc_errors;
+    uint32_t invalid;    // Bad length, type or payload
+    uint32_t bytes;      // Received
+} serial_stats_t;
+
+typedef enum {
+    SERIAL_PARSER_SYNC_1,
+    SERIAL_PARSER_SYNC_2,
+    SERIAL_PARSER_HEADER,
+    SERIAL_PARSER_PAYLOAD,
+    SERIAL_PARSER_CRC,
+} serial_parser_state_t;
+
+typedef struct {
+    serial_parser_state_t state;
+    uint8_t header[SERIAL_HEADER_SIZE];
+    uint16_t position;   // In the current part (header, payload or CRC)
+    uint16_t crc;        // Computed
+    uint16_t received_crc;
+    // Filled with the payload
+    uint8_t *payload;
+    // Of the last complete frame
+    uint8_t type;
+    uint8_t sequence;
+    uint16_t length;
+} serial_parser_t;
+
+uint16_t serial_crc16(uint16_t crc, const uint8_t *data, size_t size);
+void serial_parser_init(serial_parser_t *parser, uint8_t *payload);
+bool serial_parser_feed(serial_parser_t *parser, uint8_t byte, serial_stats_t *stats);
+size_t serial_encode_frame(uint8_t *frame, uint8_t type, uint8_t sequence,
+                           const uint8_t *payload, uint16_t length);
+bool serial_decode_pixels(uint8_t type, const uint8_t *payload, uint16_t length, framebuffer_t *fb);
+
+#endif // __SERIAL_PROTO_H__
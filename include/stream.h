@@ -0,0 +1,75 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "include/framebuffer.h"
+
+/**
+ * @brief Compressed frame stream, played from the "anims" data partition
+ *
+ * Little-endian layout:
+ *  - header (STREAM_HEADER_SIZE bytes):
+ *      magic "CBFS", version, side length, fps (16 bits),
+ *      frame count (32 bits), size of the frame records (32 bits)
+ *  - frame records: type (STREAM_FRAME_*), payload size (16 bits), payload
+ *
+ * A payload is a list of ops covering the pixels in framebuffer (x,y,z)
+ * order. Each op starts with a token: op << 6 | (pixel count - 1).
+ *  - STREAM_OP_LITERAL: one color (3 bytes: r, g, b) per pixel
+ *  - STREAM_OP_RUN: one color for all the pixels
+ *  - STREAM_OP_SKIP: no data, pixels left unchanged
+ * Colors are XORed with the previous frame; keyframes start from a black
+ * frame, so their colors are the pixel values.
+ * The first frame must be a keyframe: streams play in a loop.
+ */
+#define STREAM_MAGIC                "CBFS"
+#define STREAM_VERSION              1
+#define STREAM_HEADER_SIZE          16
+#define STREAM_RECORD_HEADER_SIZE   3
+
+#define STREAM_FRAME_KEY            0
+#define STREAM_FRAME_DELTA          1
+
+#define STREAM_OP_LITERAL           0
+#define STREAM_OP_RUN               1
+#define STREAM_OP_SKIP              2
+#define STREAM_OP_MAX_PIXELS        64
+
+// A keyframe of literals must fit in the 16 bits payload size
+_Static_assert(LED_STRIP_LED_COUNT * 3 + LED_STRIP_LED_COUNT / STREAM_OP_MAX_PIXELS <= UINT16_MAX,
+               "Frame records too large for this cube");
+
+#define STREAM_PARTITION_LABEL      "anims"
+#define STREAM_PARTITION_SUBTYPE    0x40
+
+typedef struct {
+    const uint8_t *data;   // Frame records
+    uint32_t size;
+    uint16_t fps;
+    uint32_t frame_count;
+    uint32_t offset;       // Of the next frame record
+    uint32_t frame;        // Index of the next frame
+} stream_t;
+
+esp_err_t stream_open(stream_t *stream, const uint8_t *data, size_t size);
+esp_err_t stream_decode_next(stream_t *stream, framebuffer_t *fb);
+
+#endif // __STREAM_H__
@@ -0,0 +1,61 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __STRIP_STREAM_H__
+#define __STRIP_STREAM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "include/framebuffer.h"
+
+/**
+ * @brief Bytes sent on a data line, produced from the framebuffer on demand
+ *
+ * The LEDs of the channel are read in strip order through g_frame_map and
+ * converted to GRB bytes (the WS2812 order) as they are read: gamma and
+ * brightness LUT, current limiting scale, then rounding or temporal dithering.
+ * A read may stop in the middle of a LED and resume later, so that a driver
+ * can encode the frame chunk by chunk while it is transmitted, without any
+ * copy of the frame. Nothing is allocated: usable from an ISR.
+ */
+typedef struct {
+    const uint16_t *levels;  // Strip level of each framebuffer value, 8.8 fixed point
+    uint8_t (*residues)[3];  // Fraction carried over to the next frame, per LED (strip order) and channel
+    uint32_t scale;          // Current limiting, Q16
+    bool dither;             // Carry the fractions over, round them otherwise
+} strip_levels_t;
+
+typedef struct {
+    const framebuffer_t *fb;
+    const strip_levels_t *levels;
+    pix_id_t next;      // Next LED to convert
+    pix_id_t end;       // Past the last LED of the channel
+    uint8_t grb[3];     // Bytes of the last converted LED
+    uint8_t offset;     // Next byte of grb to read, 3: all read
+    uint8_t fractions;  // Some levels fell between two strip values
+} strip_stream_t;
+
+void strip_stream_begin(strip_stream_t *stream, const framebuffer_t *fb, const strip_levels_t *levels,
+                        pix_id_t first, pix_id_t count);
+size_t strip_stream_read(strip_stream_t *stream, uint8_t *data, size_t size);
+
+/**
+ * @brief All the bytes of the channel were read
+ */
+static inline bool strip_stream_done(const strip_stream_t *stream) {
+    return stream->next == stream->end && stream->offset == 3;
+}
+
+#endif // __STRIP_STREAM_H__
@@ -0,0 +1,42 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __TRANSITION_H__
+#define __TRANSITION_H__
+
+#include <stdint.h>
+
+#include "include/commons.h"
+#include "include/framebuffer.h"
+
+/**
+ * @brief Blending of the frames of two effects during a scenario change
+ * The progress goes from 0 (outgoing frame only) to TRANSITION_END
+ * (incoming frame only).
+ */
+typedef enum {
+    TRANSITION_CUT,        // No transition
+    TRANSITION_CROSSFADE,
+    TRANSITION_WIPE_X,     // Soft edge sweeping the cube along the axis
+    TRANSITION_WIPE_Y,
+    TRANSITION_WIPE_Z,
+    TRANSITION_DISSOLVE,   // The voxels fade one after the other, in random order
+} transition_type_t;
+
+#define TRANSITION_END    256
+
+void transition_blend(transition_type_t type, uint16_t progress,
+                      const framebuffer_t *from, const framebuffer_t *to, framebuffer_t *out);
+
+#endif // __TRANSITION_H__
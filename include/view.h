@@ -0,0 +1,55 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef __VIEW_H__
+#define __VIEW_H__
+
+#include <stdint.h>
+
+#include "include/commons.h"
+
+/**
+ * @brief Transform of the whole frame on its way to the cube
+ *
+ * Rotations by quarter turns, mirrors and wrap-around scrolls: each one
+ * moves the voxels without changing them. The view is folded into the
+ * lookup table read by the output (g_frame_map, see mapping.h) when it is
+ * applied: the frames themselves cost nothing more to transmit.
+ *
+ * A voxel s of the framebuffer is shown at m * s (around the centre of
+ * the cube), then moved by scroll.
+ */
+typedef struct {
+    int8_t m[3][3];     // Signed permutation matrix
+    uint8_t scroll[3];  // Wrap-around translation along x, y, z, after m (voxels)
+} view_t;
+
+#define VIEW_ROTATION_COUNT    24  // Rotations of the cube onto itself
+
+// Rotation of the cube on its base, chained after the view of every effect:
+// one of the VIEW_ROTATION_COUNT of view_set_rotation() (0: as wired)
+#ifndef CUBE_MOUNT_ROTATION
+#define CUBE_MOUNT_ROTATION    0
+#endif
+
+_Static_assert(CUBE_MOUNT_ROTATION < VIEW_ROTATION_COUNT, "Unknown CUBE_MOUNT_ROTATION");
+
+void view_identity(view_t *view);
+void view_set_rotation(view_t *view, uint8_t index);
+void view_rotate(view_t *view, uint8_t axis, int8_t quarter_turns);
+void view_mirror(view_t *view, uint8_t axis);
+void view_scroll(view_t *view, uint8_t axis, int8_t voxels);
+void view_apply(const view_t *view);
+
+#endif // __VIEW_H__
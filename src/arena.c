@@ -0,0 +1,74 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Bump allocator over a statically sized buffer
+ */
+// Standard imports
+#include <stdint.h>
+#include <string.h>  // memset
+
+// Local imports
+#include "include/arena.h"
+
+_Static_assert(EFFECT_ARENA_SIZE % ARENA_ALIGN == 0, "Both ends of the arena must be aligned");
+
+static _Alignas(ARENA_ALIGN) uint8_t s_arena[EFFECT_ARENA_SIZE];
+// Bytes taken from the bottom and from the top of the arena
+static size_t s_used[2] = { 0, 0 };
+// End of the arena used by the next allocations: 0: bottom, 1: top
+static uint8_t s_end = 0;
+
+
+/**
+ * @brief Release all the blocks of the current end at once
+ */
+void arena_reset(void) {
+    s_used[s_end] = 0;
+}
+
+
+/**
+ * @brief Take the next blocks from the other end of the arena
+ * The blocks of the current end are kept until this end is reset.
+ */
+void arena_flip(void) {
+    s_end ^= 1;
+}
+
+
+/**
+ * @brief Get a zeroed block of the given size
+ * @return NULL if the arena is too small
+ */
+void *arena_alloc(size_t size) {
+    size_t aligned = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+    if (aligned > EFFECT_ARENA_SIZE - s_used[0] - s_used[1])
+        return NULL;
+
+    s_used[s_end] += aligned;
+    void *block = s_end ? &s_arena[EFFECT_ARENA_SIZE - s_used[1]] : &s_arena[s_used[0] - aligned];
+    memset(block, 0, size);
+    return block;
+}
+
+
+/**
+ * @brief Bytes handed out at the current end since its last reset
+ * Blocks are never freed individually: this is also the peak usage.
+ */
+size_t arena_used(void) {
+    return s_used[s_end];
+}
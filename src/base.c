@@ -21,29 +21,47 @@
 // Local imports
 #include "include/base.h"
 #include "include/commons.h"
+#include "include/mapping.h"
 
 static const char *TAG = "BASE";
 
-/**
- * @brief Entry point for a progressive red line following the natural LED indexes
- */
-void base(led_strip_handle_t *led_strip) {
-    ESP_LOGI(TAG, "Animation: Basic red line");
+#define BASE_FPS           10    // One frame per LED
+#define BASE_LED_DELAY     100   // One more LED every 100ms
+#define BASE_HOLD_DELAY    2000  // Time the full line stays on before a restart
 
-    ESP_ERROR_CHECK(led_strip_clear(*led_strip));
+typedef struct {
+    uint32_t time_ms;  // Since the start of the line
+    uint16_t lit;      // Number of LEDs on
+} base_state_t;
 
-    for (int i = 0; i < LED_STRIP_LED_COUNT; i++) {
-        ESP_ERROR_CHECK(led_strip_set_pixel(*led_strip, i, 200, 0, 0));
 
-        // Refresh the strip
-        ESP_ERROR_CHECK(led_strip_refresh(*led_strip));
+/**
+ * @brief Progressive red line following the natural LED indexes
+ */
+void base_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    base_state_t *line = state;
 
-        ESP_LOGD(TAG, "idx: %d", i);
+    line->time_ms += dt_ms;
+    if (line->time_ms >= BASE_LED_DELAY * LED_STRIP_LED_COUNT + BASE_HOLD_DELAY) {
+        // Start over
+        fb_clear(fb);
+        line->time_ms = 0;
+        line->lit = 0;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+    uint16_t target = MIN_(LED_STRIP_LED_COUNT, line->time_ms / BASE_LED_DELAY + 1);
+    for (; line->lit < target; line->lit++) {
+        voxel_t voxel = g_frame_map[line->lit];
+        fb_set_pixel(fb, voxel.x, voxel.y, voxel.z, (color_t){ .red = 200, .green = 0, .blue = 0 });
 
-        if (g_button_pressed)
-            return;
+        ESP_LOGD(TAG, "idx: %d", line->lit);
     }
-    vTaskDelay(pdMS_TO_TICKS(2000));
 }
+
+
+const effect_t g_base_effect = {
+    .name       = "base",
+    .fps        = BASE_FPS,
+    .state_size = sizeof(base_state_t),
+    .step       = base_step,
+};
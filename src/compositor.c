@@ -0,0 +1,192 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Blending of framebuffer layers with SWAR kernels
+ */
+// Standard imports
+#include <string.h>
+
+// Local imports
+#include "include/compositor.h"
+
+#define LANES_EVEN    0x00FF00FFu  // Bytes 0 and 2 of a word, as 16-bit lanes
+#define HIGH_BITS     0x80808080u
+
+
+/**
+ * @brief Scale the 4 bytes of the word by alpha/256, alpha in [0;256]
+ */
+static inline uint32_t swar_scale(uint32_t a, uint32_t alpha) {
+    uint32_t even = ((a & LANES_EVEN) * alpha >> 8) & LANES_EVEN;
+    uint32_t odd = (((a >> 8) & LANES_EVEN) * alpha >> 8) & LANES_EVEN;
+    return even | (odd << 8);
+}
+
+
+/**
+ * @brief a + (b - a) * alpha/256 on each byte, alpha in [0;256]
+ */
+static inline uint32_t swar_lerp(uint32_t a, uint32_t b, uint32_t alpha) {
+    uint32_t even = (((a & LANES_EVEN) * (256 - alpha) + (b & LANES_EVEN) * alpha) >> 8) & LANES_EVEN;
+    uint32_t odd = ((((a >> 8) & LANES_EVEN) * (256 - alpha) + ((b >> 8) & LANES_EVEN) * alpha) >> 8) & LANES_EVEN;
+    return even | (odd << 8);
+}
+
+
+/**
+ * @brief min(a + b, 255) on each byte
+ * The low 7 bits are summed without carry between the bytes; the carries
+ * out of each byte are spread to saturate it.
+ */
+static inline uint32_t swar_add(uint32_t a, uint32_t b) {
+    uint32_t sum = (a & ~HIGH_BITS) + (b & ~HIGH_BITS);
+    uint32_t carry = ((a & b) | ((a | b) & sum)) & HIGH_BITS;
+    sum ^= (a ^ b) & HIGH_BITS;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+
+/**
+ * @brief max(a, b) on each byte
+ * The low 7 bits are compared by a subtraction guarded by the high bit
+ * of each byte.
+ */
+static inline uint32_t swar_max(uint32_t a, uint32_t b) {
+    uint32_t diff = (a | HIGH_BITS) - (b & ~HIGH_BITS);
+    uint32_t greater = ((a & ~b) | (~(a ^ b) & diff)) & HIGH_BITS;
+    uint32_t mask = (greater >> 7) * 0xFF;
+    return (a & mask) | (b & ~mask);
+}
+
+
+/**
+ * @brief a * b / 255 on each byte, rounded
+ * The products of the even and odd bytes are divided in 16-bit lanes.
+ */
+static inline uint32_t swar_multiply(uint32_t a, uint32_t b) {
+    uint32_t even = (a & 0xFF) * (b & 0xFF) | ((a >> 16 & 0xFF) * (b >> 16 & 0xFF)) << 16;
+    uint32_t odd = (a >> 8 & 0xFF) * (b >> 8 & 0xFF) | ((a >> 24) * (b >> 24)) << 16;
+
+    even += 0x00800080;
+    odd += 0x00800080;
+    even = ((even + ((even >> 8) & LANES_EVEN)) >> 8) & LANES_EVEN;
+    odd = ((odd + ((odd >> 8) & LANES_EVEN)) >> 8) & LANES_EVEN;
+    return even | (odd << 8);
+}
+
+
+static inline uint32_t blend_word(uint32_t a, uint32_t b, blend_mode_t mode, uint32_t alpha) {
+    switch (mode) {
+    case BLEND_ALPHA:
+        return swar_lerp(a, b, alpha);
+    case BLEND_ADD:
+        return swar_add(a, swar_scale(b, alpha));
+    case BLEND_MULTIPLY:
+        return swar_lerp(a, swar_multiply(a, b), alpha);
+    case BLEND_MAX:
+        return swar_max(a, swar_scale(b, alpha));
+    }
+    return a;
+}
+
+
+/**
+ * @brief Blend count pixels of src over dst
+ * The pixels are processed 4 bytes at a time; the last bytes are padded
+ * into a word.
+ */
+void blend_pixels(color_t *dst, const color_t *src, uint16_t count, blend_mode_t mode, uint8_t opacity) {
+    uint8_t *d = (uint8_t *) dst;
+    const uint8_t *s = (const uint8_t *) src;
+    size_t size = count * sizeof(color_t);
+    size_t whole = size & ~(size_t) 3;
+    // Opacity in [0;256]
+    uint32_t alpha = opacity + (opacity >> 7);
+    uint32_t a, b;
+
+    for (size_t offset = 0; offset < whole; offset += 4) {
+        memcpy(&a, d + offset, 4);
+        memcpy(&b, s + offset, 4);
+        a = blend_word(a, b, mode, alpha);
+        memcpy(d + offset, &a, 4);
+    }
+
+    if (whole < size) {
+        a = b = 0;
+        memcpy(&a, d + whole, size - whole);
+        memcpy(&b, s + whole, size - whole);
+        a = blend_word(a, b, mode, alpha);
+        memcpy(d + whole, &a, size - whole);
+    }
+}
+
+
+void compositor_init(compositor_t *compositor, layer_t *layers, uint8_t count) {
+    compositor->layers = layers;
+    compositor->count = count;
+    compositor->stale = true;
+}
+
+
+void compositor_set_layer(compositor_t *compositor, uint8_t index, blend_mode_t mode, uint8_t opacity) {
+    layer_t *layer = &compositor->layers[index];
+
+    if (layer->mode == mode && layer->opacity == opacity)
+        return;
+    layer->mode = mode;
+    layer->opacity = opacity;
+    compositor->stale = true;
+}
+
+
+/**
+ * @brief Blend the layers into the given framebuffer
+ * Hidden layers are skipped; an opaque bottom layer is copied.
+ * @return False if nothing changed since the last composition: out is untouched.
+ */
+bool compositor_render(compositor_t *compositor, framebuffer_t *out) {
+    bool changed = compositor->stale;
+    for (uint8_t i = 0; i < compositor->count; i++) {
+        layer_t *layer = &compositor->layers[i];
+        changed |= layer->fb.dirty && layer->opacity > 0;
+        layer->fb.dirty = false;
+    }
+    if (!changed)
+        return false;
+
+    bool empty = true;
+    for (uint8_t i = 0; i < compositor->count; i++) {
+        const layer_t *layer = &compositor->layers[i];
+        if (layer->opacity == 0)
+            continue;
+
+        // Anything but a multiplication over black is the layer itself if opaque
+        if (empty && layer->opacity == 255 && layer->mode != BLEND_MULTIPLY) {
+            memcpy(out->pixels, layer->fb.pixels, sizeof(out->pixels));
+        } else {
+            if (empty)
+                memset(out->pixels, 0, sizeof(out->pixels));
+            blend_pixels(&out->pixels[0][0][0], &layer->fb.pixels[0][0][0], LED_STRIP_LED_COUNT,
+                         layer->mode, layer->opacity);
+        }
+        empty = false;
+    }
+    if (empty)
+        memset(out->pixels, 0, sizeof(out->pixels));
+
+    fb_recount(out);
+    compositor->stale = false;
+    return true;
+}
@@ -0,0 +1,159 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief DDP receiver: UDP packets to the framebuffer
+ *
+ * The payloads are written from the receive buffer straight into the
+ * framebuffer, through the strip to voxel mapping: there is no
+ * intermediate frame.
+ */
+// Standard imports
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/ddp.h"
+#include "include/mapping.h"
+
+static const char *TAG = "DDP";
+
+// Only one receiver can be opened: the UDP port is unique
+static uint8_t s_packet[DDP_MAX_PACKET];
+
+
+/**
+ * @brief Listen on the given UDP port
+ */
+esp_err_t ddp_open(ddp_receiver_t *receiver, uint16_t port) {
+    *receiver = (ddp_receiver_t){ .socket = -1 };
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Can't create the socket: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    struct sockaddr_in address = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(port),
+        .sin_addr.s_addr = htonl(DDP_BIND_ADDRESS),
+    };
+    if (bind(sock, (struct sockaddr *) &address, sizeof(address)) < 0
+        || fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        ESP_LOGE(TAG, "Can't listen on port %d: errno %d", port, errno);
+        close(sock);
+        return ESP_FAIL;
+    }
+
+    receiver->socket = sock;
+    ESP_LOGI(TAG, "Listening on port %d", port);
+    return ESP_OK;
+}
+
+
+void ddp_close(ddp_receiver_t *receiver) {
+    if (receiver->socket >= 0)
+        close(receiver->socket);
+    receiver->socket = -1;
+}
+
+
+/**
+ * @brief Tell if the sequence number is behind the current one
+ * Sequences are 1 to 15: the 7 numbers before the current one are late.
+ */
+static bool is_late(uint8_t current, uint8_t sequence) {
+    uint8_t distance = (current - sequence + 15) % 15;
+    return distance > 0 && distance <= 7;
+}
+
+
+/**
+ * @brief Write a packet into the framebuffer
+ * @return true if the packet ends a frame (push flag)
+ */
+bool ddp_handle_packet(ddp_receiver_t *receiver, const uint8_t *packet, size_t size,
+                       framebuffer_t *fb) {
+    if (size < DDP_HEADER_SIZE || (packet[0] & DDP_FLAG_VERSION_MASK) != DDP_FLAG_VERSION_1
+        || packet[3] != DDP_ID_DISPLAY) {
+        receiver->stats.invalid++;
+        return false;
+    }
+
+    uint8_t type = packet[2];
+    size_t header_size = DDP_HEADER_SIZE + ((packet[0] & DDP_FLAG_TIMECODE) ? DDP_TIMECODE_SIZE : 0);
+    uint32_t offset = ((uint32_t) packet[4] << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+    uint16_t length = (packet[8] << 8) | packet[9];
+    // Undefined, legacy RGB or RGB 8 bits per channel
+    if ((type != 0x00 && type != 0x01 && type != 0x0B) || size < header_size + length) {
+        receiver->stats.invalid++;
+        return false;
+    }
+
+    uint8_t sequence = packet[1] & 0x0F;
+    if (sequence && receiver->sequence) {
+        if (is_late(receiver->sequence, sequence)) {
+            receiver->stats.late++;
+            return false;
+        }
+    }
+    // A newer sequence starts a new frame, the unfinished one is merged in it
+    receiver->sequence = sequence;
+    receiver->stats.packets++;
+
+    const uint8_t *data = packet + header_size;
+    uint32_t end = MIN_(offset + length, (uint32_t) LED_STRIP_LED_COUNT * 3);
+    receiver->stats.ignored += offset + length - MAX_(end, offset);
+
+    for (uint32_t byte = offset; byte < end; ) {
+        pix_id_t index = byte / 3;
+        voxel_t voxel = g_frame_map[index];
+        color_t *pixel = &fb->pixels[voxel.x][voxel.y][voxel.z];
+        uint8_t channels[3] = { pixel->red, pixel->green, pixel->blue };
+
+        // Partial pixels at the start or the end of the payload keep their other channels
+        for (uint8_t channel = byte % 3; channel < 3 && byte < end; channel++, byte++)
+            channels[channel] = data[byte - offset];
+        fb_write(fb, pixel, (color_t){ .red = channels[0], .green = channels[1], .blue = channels[2] });
+    }
+
+    if (packet[0] & DDP_FLAG_PUSH) {
+        receiver->stats.frames++;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Process the pending packets, stop after the end of a frame
+ * @return true if a frame is complete in the framebuffer
+ */
+bool ddp_poll(ddp_receiver_t *receiver, framebuffer_t *fb) {
+    while (1) {
+        ssize_t size = recv(receiver->socket, s_packet, sizeof(s_packet), 0);
+        if (size < 0)
+            return false;  // EAGAIN: nothing more for now
+
+        if (ddp_handle_packet(receiver, s_packet, size, fb))
+            return true;
+    }
+}
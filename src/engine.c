@@ -0,0 +1,333 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Effect engine: timing, input and output of the registered effects
+ */
+// Espressif imports
+#include <esp_log.h>
+#include <esp_system.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Local imports
+#include "include/engine.h"
+#include "include/commons.h"
+#include "include/output.h"
+#include "include/frame_clock.h"
+#include "include/arena.h"
+#include "include/view.h"
+
+static const char *TAG = "ENGINE";
+
+static uint16_t s_time_scale = ENGINE_TIME_SCALE_NORMAL;
+static uint32_t s_heap_free_start;
+static uint32_t s_heap_free_min;
+
+static transition_type_t s_transition = ENGINE_TRANSITION;
+static uint16_t s_transition_ms = ENGINE_TRANSITION_MS;
+// Effect left running by engine_run(), faded out at the next scenario change
+static const effect_t *s_effect = NULL;
+static void *s_state = NULL;
+// Frames of the outgoing and the incoming effects during a transition
+static framebuffer_t s_layers[2];
+
+
+/**
+ * @brief Speed up (> 100) or slow down (< 100) the time seen by the effects
+ */
+void engine_set_time_scale(uint16_t percent) {
+    s_time_scale = percent;
+}
+
+
+/**
+ * @brief Set the transition shown at the scenario changes
+ * @param duration_ms 0: cut
+ */
+void engine_set_transition(transition_type_t type, uint16_t duration_ms) {
+    s_transition = type;
+    s_transition_ms = duration_ms;
+}
+
+
+/**
+ * @brief Set up the state of the effect and its first frame, keeping the current view
+ * See engine_begin().
+ */
+static void *engine_start(const effect_t *effect, framebuffer_t *fb) {
+    arena_reset();
+    void *state = arena_alloc(MAX_(1, effect->state_size));
+    if (!state) {
+        ESP_LOGE(TAG, "%s: state of %u bytes > arena of %u bytes",
+                 effect->name, (unsigned) effect->state_size, (unsigned) EFFECT_ARENA_SIZE);
+        return NULL;
+    }
+
+    s_heap_free_start = esp_get_free_heap_size();
+    s_heap_free_min = s_heap_free_start;
+
+    output_set_dithering(effect->fps >= OUTPUT_DITHER_MIN_FPS);
+    fb_clear(fb);
+    if (effect->init)
+        effect->init(state, effect->config);
+
+    engine_sample_usage();
+    return state;
+}
+
+
+/**
+ * @brief Set up the state of the effect and its first frame
+ * The state is carved from the arena, which is reset first:
+ * the previous effect must be ended. The dithering errors of the previous
+ * effect are dropped: the frames only depend on the effect.
+ * @return The zeroed state of the effect, NULL if the arena is too small
+ */
+void *engine_begin(const effect_t *effect, framebuffer_t *fb) {
+    output_reset_dithering();
+    // The frame map is read while the frames are sent: rebuild it between two
+    output_flush();
+    view_apply(effect->view);
+    return engine_start(effect, fb);
+}
+
+
+/**
+ * @brief Track the lowest free heap seen while the effect runs
+ */
+void engine_sample_usage(void) {
+    s_heap_free_min = MIN_(s_heap_free_min, esp_get_free_heap_size());
+}
+
+
+/**
+ * @brief Tear down the effect and report its memory usage
+ * @param usage Optional
+ */
+void engine_end(const effect_t *effect, void *state, engine_usage_t *usage) {
+    if (effect->teardown)
+        effect->teardown(state);
+
+    engine_usage_t current = {
+        .arena_used     = arena_used(),
+        .heap_peak      = s_heap_free_start - s_heap_free_min,
+        .stack_free_min = uxTaskGetStackHighWaterMark(NULL),
+    };
+    ESP_LOGI(TAG, "%s: arena: %u/%u bytes, heap: %" PRIu32 " bytes, stack free: %" PRIu32 " bytes",
+             effect->name, (unsigned) current.arena_used, (unsigned) EFFECT_ARENA_SIZE,
+             current.heap_peak, current.stack_free_min);
+    if (usage)
+        *usage = current;
+}
+
+
+/**
+ * @brief Start the incoming effect of a transition, next to the outgoing one
+ * The incoming state is carved from the other end of the arena and rendered
+ * in its own layer; both layers are shown through the view of the outgoing
+ * effect, the one of the incoming effect is applied by engine_transition_end().
+ * The frames are dithered if one of the effects needs it.
+ * @param fb Back buffer, holding the last frame of the outgoing effect
+ * @return The state of the incoming effect, NULL if the transition can't be
+ *      shown (cut, states too large for the arena, or effects with different
+ *      views: the frame map holds a single view): the outgoing effect is
+ *      left untouched
+ */
+void *engine_transition_begin(engine_transition_t *transition, const effect_t *from, void *from_state,
+                              const effect_t *to, framebuffer_t *fb) {
+    if (s_transition == TRANSITION_CUT || s_transition_ms == 0 || from->view != to->view)
+        return NULL;
+
+    arena_flip();
+    void *to_state = engine_start(to, &s_layers[1]);
+    if (!to_state) {
+        arena_flip();
+        return NULL;
+    }
+    output_set_dithering(MAX_(from->fps, to->fps) >= OUTPUT_DITHER_MIN_FPS);
+    memcpy(&s_layers[0], fb, sizeof(framebuffer_t));
+
+    *transition = (engine_transition_t){
+        .from       = from,
+        .from_state = from_state,
+        .to         = to,
+        .to_state   = to_state,
+    };
+    return to_state;
+}
+
+
+/**
+ * @brief Step the effects of the transition that are due
+ * They step by whole periods of their own frame rate, the remainder is
+ * kept for the next step; the incoming effect is first stepped with 0 ms.
+ */
+void engine_transition_step(engine_transition_t *transition) {
+    uint32_t from_period_ms = 1000u / transition->from->fps;
+    uint32_t to_period_ms = 1000u / transition->to->fps;
+
+    if (transition->from_ms >= from_period_ms) {
+        uint32_t step_ms = transition->from_ms - transition->from_ms % from_period_ms;
+        transition->from->step(transition->from_state, step_ms, &s_layers[0]);
+        transition->from_ms -= step_ms;
+    }
+    if (!transition->to_started) {
+        transition->to->step(transition->to_state, 0, &s_layers[1]);
+        transition->to_ms = 0;
+        transition->to_started = true;
+    } else if (transition->to_ms >= to_period_ms) {
+        uint32_t step_ms = transition->to_ms - transition->to_ms % to_period_ms;
+        transition->to->step(transition->to_state, step_ms, &s_layers[1]);
+        transition->to_ms -= step_ms;
+    }
+}
+
+
+/**
+ * @brief Blend the frames of both effects into the given buffer
+ */
+void engine_transition_blend(const engine_transition_t *transition, framebuffer_t *fb) {
+    uint16_t progress = transition->elapsed_ms * TRANSITION_END / s_transition_ms;
+    transition_blend(s_transition, progress, &s_layers[0], &s_layers[1], fb);
+}
+
+
+/**
+ * @brief Let the given time pass
+ * @return False once the transition is over
+ */
+bool engine_transition_advance(engine_transition_t *transition, uint32_t dt_ms) {
+    transition->elapsed_ms += dt_ms;
+    transition->from_ms += dt_ms;
+    transition->to_ms += dt_ms;
+    return transition->elapsed_ms < s_transition_ms;
+}
+
+
+/**
+ * @brief Show the incoming effect alone and tear down the outgoing one
+ * The incoming effect goes on in the output buffers, with its own view and
+ * dithering; its state is left in the current end of the arena.
+ * @param fb Back buffer
+ * @return Time since the last step of the incoming effect: dt of its next step
+ */
+uint32_t engine_transition_end(engine_transition_t *transition, framebuffer_t *fb) {
+    memcpy(fb, &s_layers[1], sizeof(framebuffer_t));
+    // The frame map is read while the frames are sent: rebuild it between two
+    output_flush();
+    view_apply(transition->to->view);
+    output_set_dithering(transition->to->fps >= OUTPUT_DITHER_MIN_FPS);
+
+    // Release the outgoing end of the arena
+    arena_flip();
+    engine_end(transition->from, transition->from_state, NULL);
+    arena_reset();
+    arena_flip();
+    return transition->to_ms;
+}
+
+
+/**
+ * @brief Show the transition from the outgoing effect to the incoming one
+ * Both effects keep running in their own layer, each at its own frame
+ * rate: the frame clock follows the fastest one.
+ * @return False if the button was pressed: the transition is cut short
+ */
+static bool engine_play_transition(engine_transition_t *transition, framebuffer_t **fb) {
+    frame_clock_t clock;
+    frame_clock_init(&clock, MAX_(transition->from->fps, transition->to->fps));
+    uint32_t period_ms = pdTICKS_TO_MS(clock.period);
+    uint32_t dt_ms;
+
+    do {
+        engine_transition_step(transition);
+        engine_transition_blend(transition, *fb);
+        *fb = output_present();
+        engine_sample_usage();
+
+        if (g_button_pressed) {
+            frame_clock_log_stats(&clock, "transition");
+            return false;
+        }
+
+        dt_ms = frame_clock_wait(&clock) * period_ms * s_time_scale / ENGINE_TIME_SCALE_NORMAL;
+    } while (engine_transition_advance(transition, dt_ms));
+
+    frame_clock_log_stats(&clock, "transition");
+    return true;
+}
+
+
+/**
+ * @brief Run the given effect at its frame rate until a button event
+ * The effect fades in from the previous one (see engine_set_transition()
+ * and engine_transition_begin()); it is left running on return, to be
+ * faded out by the next call.
+ * @return The event that stopped the effect
+ */
+input_event_t engine_run(const effect_t *effect) {
+    ESP_LOGI(TAG, "Animation: %s", effect->name);
+
+    framebuffer_t *fb = output_get_back_buffer();
+    const effect_t *outgoing = s_effect;
+    engine_transition_t transition;
+    void *state = NULL;
+
+    if (outgoing)
+        state = engine_transition_begin(&transition, outgoing, s_state, effect, fb);
+    if (!state) {
+        // Cut
+        if (outgoing)
+            engine_end(outgoing, s_state, NULL);
+        outgoing = NULL;
+        state = engine_begin(effect, fb);
+    }
+    s_effect = state ? effect : NULL;
+    s_state = state;
+    if (!state) {
+        // Skip to the next scenario
+        return INPUT_EVENT_SHORT_PRESS;
+    }
+
+    output_reset_stats();
+    bool pressed = false;
+    uint32_t dt_ms = 0;
+    if (outgoing) {
+        pressed = !engine_play_transition(&transition, &fb);
+        // The time elapsed since its last step is carried to the next one
+        dt_ms = engine_transition_end(&transition, fb);
+    }
+
+    frame_clock_t clock;
+    frame_clock_init(&clock, effect->fps);
+    uint32_t period_ms = pdTICKS_TO_MS(clock.period);
+
+    while (!pressed) {
+        effect->step(state, dt_ms, fb);
+        fb = output_present();
+        engine_sample_usage();
+
+        if (g_button_pressed)
+            break;
+
+        uint32_t elapsed_frames = frame_clock_wait(&clock);
+        dt_ms = elapsed_frames * period_ms * s_time_scale / ENGINE_TIME_SCALE_NORMAL;
+    }
+
+    frame_clock_log_stats(&clock, effect->name);
+    output_log_stats();
+    return input_take_event();
+}
@@ -15,15 +15,13 @@
 /**
  * @brief Fire animation
  */
-// Standard imports
-#include <string.h>  // memset
-
 // Espressif imports
 #include <esp_log.h>
 
 // Local imports
 #include "include/fire.h"
 #include "include/commons.h"
+#include "include/prng.h"
 
 static const char *TAG = "FIRE";
 
@@ -33,15 +31,32 @@ static const char *TAG = "FIRE";
 #define MAX_COOLING     220 // Wider range in values leads to more variation
 #define MIN_SPARKING    100 // Sparking leads to a flame which progresses up the strip, more sparks=more flames
 #define MAX_SPARKING    150 // Wider range in values leads to more variation
-#define FRAME_DELAY     20  // The millisecond delay for each frame, 50ms = 20 FPS
-
+#define FIRE_FPS        50  // Target frame rate, 20ms per frame
+#define FIRE_TICK_MS    (1000 / FIRE_FPS)  // Period of the simulation
+
+typedef struct {
+    bool red_flames;  // Green flames if false
+} fire_config_t;
+
+typedef struct {
+    prng_t rng;
+    const color_t (*palette)[256];  // Palette of the flame colour
+    uint32_t elapsed_ms;            // Since the last tick of the simulation
+    bool started;
+    uint8_t heat[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];  // Heat of each cell, (x,y,z) order
+} fire_state_t;
+
+// Heat to color lookup tables of the green and red flames, indexed by (z, heat):
+// both fires can run at once (transitions)
+static color_t s_heat_palettes[2][SIDE_LENGTH][256];
+static bool s_palette_built[2] = { false, false };
 
 /**
- * @brief Get the color of the selected pixel in the selected strand according to the heat value
+ * @brief Get the color of a pixel at the height z according to its heat value
  * @param red_flames Green flames if false, red flames otherwise.
  */
-color_t get_pixel_heat_color(uint8_t strand, int z, uint8_t heat_value, bool red_flames) {
-    // ESP_LOGI(TAG, "strand: %d, z: %d, heat: %d", strand, z, heat_value);
+color_t get_pixel_heat_color(int z, uint8_t heat_value, bool red_flames) {
+    // ESP_LOGI(TAG, "z: %d, heat: %d", z, heat_value);
 
     // Scale 'heat' down from 0-255 to 0-191
     uint8_t t192 = (heat_value * 191) / 255;
@@ -81,22 +96,43 @@ color_t get_pixel_heat_color(uint8_t strand, int z, uint8_t heat_value, bool red
 }
 
 
+/**
+ * @brief Precompute the colors of all the (z, heat) pairs
+ * Each palette is only built on its first use.
+ * @return The palette of the given flame colour
+ */
+const color_t (*build_heat_palette(bool red_flames))[256] {
+    color_t (*palette)[256] = s_heat_palettes[red_flames];
+    if (s_palette_built[red_flames])
+        return palette;
+
+    for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+        for (uint16_t heat = 0; heat < 256; heat++) {
+            palette[z][heat] = get_pixel_heat_color(z, heat, red_flames);
+        }
+    }
+    s_palette_built[red_flames] = true;
+    ESP_LOGD(TAG, "Heat palette built for %s flames", red_flames ? "red" : "green");
+    return palette;
+}
+
+
 /**
  * @brief Apply the fire effect on the given column
  */
-void column_fire(led_strip_handle_t *led_strip, uint8_t col, uint8_t y, bool red_flames) {
+void column_fire(fire_state_t *fire, framebuffer_t *fb, uint8_t col, uint8_t y) {
     // Cooling & sparking limits for the current strand
-    uint8_t cooling = (rand() % (255 - MAX_COOLING + 1)) + MIN_COOLING;
-    uint8_t sparking = (rand() % (255 - MAX_SPARKING + 1)) + MIN_SPARKING;
+    uint8_t cooling = prng_below(&fire->rng, 255 - MAX_COOLING + 1) + MIN_COOLING;
+    uint8_t sparking = prng_below(&fire->rng, 255 - MAX_SPARKING + 1) + MIN_SPARKING;
 
     // Working strand
-    uint8_t (*strand)[SIDE_LENGTH] = &g_cube[col][y];
+    uint8_t (*strand)[SIDE_LENGTH] = &fire->heat[col][y];
 
     // Cool down every cell a little
     for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
         // 0;552 ... ???? TODO uint8_t
         // Cooling * 10 ?
-        (*strand)[z] = MAX_(0, (*strand)[z] - (rand() % ((cooling) / SIDE_LENGTH) + 2));
+        (*strand)[z] = MAX_(0, (*strand)[z] - (int) (prng_below(&fire->rng, cooling / SIDE_LENGTH) + 2));
     }
 
     // Heat from each cell drifts 'up' and diffuses a little
@@ -106,57 +142,78 @@ void column_fire(led_strip_handle_t *led_strip, uint8_t col, uint8_t y, bool red
     }
 
     // Randomly ignite new 'sparks' near the bottom (2 first z-index)
-    if ((rand() % 256) < sparking) {
-        uint8_t z = rand() % 2;
+    if ((prng_next(&fire->rng) & 0xFF) < sparking) {
+        uint8_t z = prng_below(&fire->rng, 2);
         uint8_t heat_value = (*strand)[z];
         // ESP_LOGI(TAG, "heat: %d [BEFORE]", heat_value);
-        heat_value = (rand() % (255 - heat_value + 1)) + heat_value;
+        heat_value = prng_range(&fire->rng, heat_value, 255);
         // ESP_LOGI(TAG, "heat: %d", heat_value);
         (*strand)[z] = heat_value;
     }
 
     // Step 4. Convert heat to color and set pixels
     for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
-        color_t color = get_pixel_heat_color(col, z, (*strand)[z], red_flames);
-
-#ifndef PIO_QEMU_ENV
-        led_strip_set_pixel(*led_strip, get_pix_id(col, y, z), color.red, color.green, color.blue);
-#endif
+        fb_set_pixel(fb, col, y, z, fire->palette[z][(*strand)[z]]);
     }
 }
 
 
 /**
- * @brief Entry point for the fire animation
+ * @brief Initialization of the fire animation
  *
  * Inspired from https://www.hauntforum.com/threads/chatgpt-and-i-design-a-flicker-fire-effect-for-arduino-and-neopixels.48028/
  * Barely works...
  */
-void fire(led_strip_handle_t *led_strip, bool red_flames) {
-    ESP_LOGI(TAG, "Animation: fire");
+void fire_init(void *state, const void *config) {
+    const fire_config_t *fire_config = config;
+    fire_state_t *fire = state;
+
+    fire->palette = build_heat_palette(fire_config->red_flames);
+    prng_init(&fire->rng);
+}
 
-    // Clear buffer
-    memset(g_cube, 0, sizeof(uint8_t) * SIDE_LENGTH * SIDE_LENGTH * SIDE_LENGTH);
 
-#ifndef PIO_QEMU_ENV
-    ESP_ERROR_CHECK(led_strip_clear(*led_strip));
-#endif
+/**
+ * @brief Step of the fire animation
+ * The simulation runs one tick per FIRE_TICK_MS elapsed, the remainder is
+ * kept for the next step; the first step runs a single tick.
+ */
+void fire_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    fire_state_t *fire = state;
+    uint32_t ticks = 1;
+
+    if (fire->started) {
+        fire->elapsed_ms += dt_ms;
+        ticks = fire->elapsed_ms / FIRE_TICK_MS;
+        fire->elapsed_ms -= ticks * FIRE_TICK_MS;
+    }
+    fire->started = true;
 
-    while (1) {
+    for (; ticks > 0; ticks--) {
         for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
             for (uint8_t col = 0; col < SIDE_LENGTH; col++) {
-                column_fire(led_strip, col, y, red_flames);
+                column_fire(fire, fb, col, y);
                 // ESP_LOGI(TAG, "end strand");
             }
         }
-
-#ifndef PIO_QEMU_ENV
-        ESP_ERROR_CHECK(led_strip_refresh(*led_strip));
-#endif
-
-        if (g_button_pressed)
-            break;
-
-        vTaskDelay(pdMS_TO_TICKS(FRAME_DELAY));
     }
 }
+
+
+const effect_t g_red_fire_effect = {
+    .name       = "red_fire",
+    .fps        = FIRE_FPS,
+    .state_size = sizeof(fire_state_t),
+    .config     = &(const fire_config_t){ .red_flames = true },
+    .init       = fire_init,
+    .step       = fire_step,
+};
+
+const effect_t g_green_fire_effect = {
+    .name       = "green_fire",
+    .fps        = FIRE_FPS,
+    .state_size = sizeof(fire_state_t),
+    .config     = &(const fire_config_t){ .red_flames = false },
+    .init       = fire_init,
+    .step       = fire_step,
+};
@@ -0,0 +1,110 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Fireworks animation
+ * A fountain of sparks at the bottom, and shells bursting in the air,
+ * drawn by the particle system.
+ */
+// Local imports
+#include "include/fireworks.h"
+#include "include/commons.h"
+#include "include/particles.h"
+#include "include/prng.h"
+
+#define FIREWORKS_FPS            50
+#define FIREWORKS_SHELL_DELAY    900  // Time between two bursts (ms)
+
+typedef struct {
+    prng_t rng;
+    particle_pool_t pool;
+    particle_emitter_t fountain;
+    uint32_t shell_ms;  // Time since the last burst
+} fireworks_state_t;
+
+static const color_t fireworks_colors[] = {
+    { .red = 0xFF, .green = 0x20, .blue = 0x00 },
+    { .red = 0x00, .green = 0xFF, .blue = 0x40 },
+    { .red = 0x30, .green = 0x40, .blue = 0xFF },
+    { .red = 0xFF, .green = 0xC0, .blue = 0x00 },
+    { .red = 0xC0, .green = 0x00, .blue = 0xFF },
+};
+#define FIREWORKS_COLOR_COUNT    (sizeof(fireworks_colors) / sizeof(fireworks_colors[0]))
+
+
+void fireworks_init(void *state, const void *config) {
+    (void) config;
+    fireworks_state_t *fireworks = state;
+    // Speeds and lengths follow the size of the cube, Q8
+    int16_t side = SIDE_LENGTH << 8;
+
+    prng_init(&fireworks->rng);
+    // Sparks rise to ~3/4 of the cube
+    particle_pool_init(&fireworks->pool, -2 * side, true);
+
+    fireworks->fountain = (particle_emitter_t) {
+        .position = { side / 2 - 128, side / 2 - 128, 0 },
+        .position_spread = 64,
+        .velocity = { 0, 0, side * 7 / 4 },
+        .velocity_spread = side / 4,
+        .life_ms = 1000,
+        .life_spread_ms = 300,
+        .color = { .red = 0xFF, .green = 0x60, .blue = 0x10 },
+        .rate = PARTICLE_CAPACITY / 2,
+    };
+}
+
+
+/**
+ * @brief Step of the fireworks effect
+ * The frame is redrawn from scratch with the particles of the pool.
+ */
+void fireworks_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    fireworks_state_t *fireworks = state;
+    int16_t side = SIDE_LENGTH << 8;
+
+    particle_update(&fireworks->pool, dt_ms);
+    particle_emit(&fireworks->pool, &fireworks->fountain, &fireworks->rng, dt_ms);
+
+    fireworks->shell_ms += dt_ms;
+    if (fireworks->shell_ms >= FIREWORKS_SHELL_DELAY) {
+        fireworks->shell_ms -= FIREWORKS_SHELL_DELAY;
+
+        // Burst somewhere in the upper half, in all directions
+        particle_emitter_t shell = {
+            .position = {
+                prng_below(&fireworks->rng, side),
+                prng_below(&fireworks->rng, side),
+                side / 2 + prng_below(&fireworks->rng, side / 2),
+            },
+            .velocity_spread = side,
+            .life_ms = 700,
+            .life_spread_ms = 200,
+            .color = fireworks_colors[prng_below(&fireworks->rng, FIREWORKS_COLOR_COUNT)],
+        };
+        particle_burst(&fireworks->pool, &shell, &fireworks->rng, PARTICLE_CAPACITY / 3);
+    }
+
+    fb_clear(fb);
+    particle_splat(&fireworks->pool, fb);
+}
+
+
+const effect_t g_fireworks_effect = {
+    .name       = "fireworks",
+    .fps        = FIREWORKS_FPS,
+    .state_size = sizeof(fireworks_state_t),
+    .init       = fireworks_init,
+    .step       = fireworks_step,
+};
@@ -0,0 +1,82 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Fixed-rate frame scheduler with deadline tracking
+ */
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/frame_clock.h"
+#include "include/commons.h"
+
+
+/**
+ * @brief Start a new schedule at the given frame rate
+ * The period is rounded to the tick resolution (CONFIG_FREERTOS_HZ).
+ */
+void frame_clock_init(frame_clock_t *clock, uint16_t fps) {
+    clock->period = MAX_(1, (configTICK_RATE_HZ + fps / 2) / fps);
+    clock->last_wake = xTaskGetTickCount();
+    clock->frames = 0;
+    clock->missed = 0;
+    clock->skipped = 0;
+}
+
+
+/**
+ * @brief Wait for the start of the next frame slot
+ *
+ * A frame a bit late is shown immediately and the next one keeps its
+ * deadline, so the schedule catches up instead of slipping.
+ * When the rendering overruns by whole periods, these frame slots are
+ * dropped to stay on the original time grid.
+ *
+ * The wait is aborted by a notification of the calling task (button event,
+ * see input.c); the next deadline stays on the grid.
+ * @return Number of frame periods since the previous call:
+ *      1 on time, more if frames were skipped.
+ */
+uint32_t frame_clock_wait(frame_clock_t *clock) {
+    TickType_t deadline = clock->last_wake + clock->period;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsed_frames = 1;
+
+    clock->frames++;
+
+    if ((int32_t) (now - deadline) > 0) {
+        uint32_t late_frames = (now - deadline) / clock->period;
+
+        clock->missed++;
+        clock->skipped += late_frames;
+        clock->last_wake += late_frames * clock->period;
+        elapsed_frames += late_frames;
+    }
+
+    clock->last_wake += clock->period;
+    TickType_t remaining = ((int32_t) (clock->last_wake - now) > 0) ? clock->last_wake - now : 0;
+    ulTaskNotifyTake(pdTRUE, remaining);
+    return elapsed_frames;
+}
+
+
+void frame_clock_log_stats(const frame_clock_t *clock, const char *tag) {
+    ESP_LOGI(tag, "frames: %" PRIu32 ", missed deadlines: %" PRIu32 ", skipped: %" PRIu32,
+             clock->frames, clock->missed, clock->skipped);
+}
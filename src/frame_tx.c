@@ -0,0 +1,230 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Custom RMT encoder of the WS2812 frames, see frame_tx.h
+ *
+ * The encoder chains a bytes encoder fed with the chunks of the stream,
+ * then a copy encoder for the reset code. The RMT driver calls it from its
+ * ISR each time the symbol memory has room; a full memory interrupts the
+ * chunk, which is encoded again from where it stopped on the next call.
+ */
+// Standard imports
+#include <stdlib.h>
+
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+
+// Espressif imports
+#include <esp_check.h>
+#include <esp_timer.h>
+#include <driver/rmt_tx.h>
+#include <soc/soc_caps.h>
+
+// Local imports
+#include "include/frame_tx.h"
+
+static const char *TAG = "FRAME_TX";
+
+// 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
+#define FRAME_TX_RES_HZ          (10 * 1000 * 1000)
+#define FRAME_TX_DMA_SYMBOLS     1024
+// WS2812 timings, in ticks
+#define WS2812_T0H               3   // 0.3us
+#define WS2812_T0L               9   // 0.9us
+#define WS2812_T1H               9   // 0.9us
+#define WS2812_T1L               3   // 0.3us
+#define WS2812_RESET_TICKS       500 // 50us low, in two symbol halves
+
+enum frame_tx_phase { PHASE_PIXELS, PHASE_RESET };
+
+struct frame_tx_t {
+    rmt_encoder_t base;
+    rmt_encoder_handle_t bytes_encoder;
+    rmt_encoder_handle_t copy_encoder;
+    rmt_symbol_word_t reset_code;
+    rmt_channel_handle_t channel;
+    enum frame_tx_phase phase;
+    strip_stream_t *stream;               // Read by the ISR during the transmission
+    uint8_t chunk[FRAME_TX_CHUNK_SIZE];   // Being encoded
+    size_t chunk_size;
+    volatile int64_t done_us;             // End of the last transmission, set by the ISR
+};
+
+
+/**
+ * @brief Encode the stream then the reset code, as far as the RMT memory allows
+ * The primary data is ignored: the bytes come from the stream.
+ */
+static size_t frame_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                           const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state) {
+    (void) primary_data;
+    (void) data_size;
+    struct frame_tx_t *tx = __containerof(encoder, struct frame_tx_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+
+    while (tx->phase == PHASE_PIXELS) {
+        if (!tx->chunk_size) {
+            tx->chunk_size = strip_stream_read(tx->stream, tx->chunk, sizeof(tx->chunk));
+            if (!tx->chunk_size) {
+                tx->phase = PHASE_RESET;
+                break;
+            }
+        }
+        encoded_symbols += tx->bytes_encoder->encode(tx->bytes_encoder, channel, tx->chunk,
+                                                     tx->chunk_size, &session_state);
+        // The bytes encoder starts over by itself once a chunk is complete
+        if (session_state & RMT_ENCODING_COMPLETE)
+            tx->chunk_size = 0;
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return encoded_symbols;
+        }
+    }
+
+    encoded_symbols += tx->copy_encoder->encode(tx->copy_encoder, channel, &tx->reset_code,
+                                                sizeof(tx->reset_code), &session_state);
+    if (session_state & RMT_ENCODING_COMPLETE) {
+        tx->phase = PHASE_PIXELS;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+    if (session_state & RMT_ENCODING_MEM_FULL)
+        state |= RMT_ENCODING_MEM_FULL;
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+
+static esp_err_t frame_encoder_reset(rmt_encoder_t *encoder) {
+    struct frame_tx_t *tx = __containerof(encoder, struct frame_tx_t, base);
+
+    rmt_encoder_reset(tx->bytes_encoder);
+    rmt_encoder_reset(tx->copy_encoder);
+    tx->phase = PHASE_PIXELS;
+    tx->chunk_size = 0;
+    return ESP_OK;
+}
+
+
+static esp_err_t frame_encoder_del(rmt_encoder_t *encoder) {
+    // Owned by the transmitter, released by frame_tx_del()
+    (void) encoder;
+    return ESP_OK;
+}
+
+
+/**
+ * @brief Time stamp the end of the transmission, from the RMT ISR
+ */
+static bool IRAM_ATTR frame_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                                    void *user_ctx) {
+    (void) channel;
+    (void) edata;
+    struct frame_tx_t *tx = user_ctx;
+
+    tx->done_us = esp_timer_get_time();
+    return false;  // No task woken
+}
+
+
+/**
+ * @brief Create a transmitter on a new RMT TX channel
+ * @param with_dma Only one channel can use the DMA (not available on C6)
+ */
+esp_err_t frame_tx_new_rmt(int gpio_num, bool with_dma, frame_tx_handle_t *ret_tx) {
+    esp_err_t ret = ESP_OK;
+    struct frame_tx_t *tx = calloc(1, sizeof(struct frame_tx_t));
+    ESP_RETURN_ON_FALSE(tx, ESP_ERR_NO_MEM, TAG, "no memory for the transmitter");
+
+    tx->base.encode = frame_encode;
+    tx->base.reset = frame_encoder_reset;
+    tx->base.del = frame_encoder_del;
+
+    rmt_bytes_encoder_config_t bytes_config = {
+        .bit0 = { .level0 = 1, .duration0 = WS2812_T0H, .level1 = 0, .duration1 = WS2812_T0L },
+        .bit1 = { .level0 = 1, .duration0 = WS2812_T1H, .level1 = 0, .duration1 = WS2812_T1L },
+        .flags.msb_first = 1,
+    };
+    rmt_copy_encoder_config_t copy_config = {};
+    rmt_tx_event_callbacks_t callbacks = { .on_trans_done = frame_tx_done };
+    tx->reset_code = (rmt_symbol_word_t) {
+        .level0 = 0, .duration0 = WS2812_RESET_TICKS / 2,
+        .level1 = 0, .duration1 = WS2812_RESET_TICKS / 2,
+    };
+    rmt_tx_channel_config_t channel_config = {
+        .gpio_num          = gpio_num,
+        .clk_src           = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz     = FRAME_TX_RES_HZ,
+        .mem_block_symbols = with_dma ? FRAME_TX_DMA_SYMBOLS : SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .trans_queue_depth = 1,
+        .flags.with_dma    = with_dma,
+    };
+
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_config, &tx->bytes_encoder), err, TAG, "bytes encoder");
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_config, &tx->copy_encoder), err, TAG, "copy encoder");
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&channel_config, &tx->channel), err, TAG, "TX channel");
+    ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(tx->channel, &callbacks, tx), err, TAG, "callbacks");
+    ESP_GOTO_ON_ERROR(rmt_enable(tx->channel), err, TAG, "enable");
+
+    *ret_tx = tx;
+    return ESP_OK;
+
+err:
+    frame_tx_del(tx);
+    return ret;
+}
+
+
+/**
+ * @brief Start the transmission of the stream, returns right away
+ * The stream is read until the end of the transmission.
+ */
+esp_err_t frame_tx_transmit(frame_tx_handle_t tx, strip_stream_t *stream) {
+    rmt_transmit_config_t config = { .loop_count = 0 };
+
+    tx->stream = stream;
+    return rmt_transmit(tx->channel, &tx->base, stream, sizeof(strip_stream_t), &config);
+}
+
+
+/**
+ * @brief Wait for the end of the transmission
+ * @param done_us Optional, set to the time (esp_timer) at which the transmission
+ *      ended, whenever this function is called
+ */
+esp_err_t frame_tx_wait_done(frame_tx_handle_t tx, int64_t *done_us) {
+    esp_err_t ret = rmt_tx_wait_all_done(tx->channel, portMAX_DELAY);
+    if (done_us)
+        *done_us = tx->done_us;
+    return ret;
+}
+
+
+esp_err_t frame_tx_del(frame_tx_handle_t tx) {
+    if (!tx)
+        return ESP_ERR_INVALID_ARG;
+
+    if (tx->channel) {
+        rmt_disable(tx->channel);
+        rmt_del_channel(tx->channel);
+    }
+    if (tx->bytes_encoder)
+        rmt_del_encoder(tx->bytes_encoder);
+    if (tx->copy_encoder)
+        rmt_del_encoder(tx->copy_encoder);
+    free(tx);
+    return ESP_OK;
+}
@@ -0,0 +1,143 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Button input: debouncing, long press detection & scenario interruption
+ *
+ * The ISR only queues the raw edges. A task filters them and turns them
+ * into events; each event sets g_button_pressed and sends a notification
+ * to the rendering task. The frame clock waits on this notification,
+ * so the running effect wakes up immediately and exits.
+ */
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/input.h"
+#include "include/commons.h"
+
+static const char *TAG = "INPUT";
+
+#define INPUT_QUEUE_LENGTH    16
+
+static QueueHandle_t s_edges;
+static TaskHandle_t s_render_task;
+static volatile input_event_t s_pending_event = INPUT_EVENT_NONE;
+
+
+/**
+ * @brief Turn the raw edges into debounced short/long press events
+ */
+static void input_task(void *arg) {
+    (void) arg;
+    bool pressed = false;
+    bool long_press_sent = false;
+    TickType_t press_time = 0;
+    bool level;
+
+    while (1) {
+        TickType_t timeout = portMAX_DELAY;
+        if (pressed && !long_press_sent) {
+            TickType_t held = xTaskGetTickCount() - press_time;
+            TickType_t long_press = pdMS_TO_TICKS(INPUT_LONG_PRESS_MS);
+            timeout = (held < long_press) ? long_press - held : 0;
+        }
+
+        if (xQueueReceive(s_edges, &level, timeout) != pdTRUE) {
+            // Still held
+            long_press_sent = true;
+            input_post_event(INPUT_EVENT_LONG_PRESS);
+            continue;
+        }
+
+        // Bounces: wait for the line to be stable, keep the last level
+        while (xQueueReceive(s_edges, &level, pdMS_TO_TICKS(INPUT_DEBOUNCE_MS)) == pdTRUE)
+            continue;
+
+        if (level == pressed)
+            continue;
+
+        pressed = level;
+        if (pressed) {
+            press_time = xTaskGetTickCount();
+            long_press_sent = false;
+        } else if (!long_press_sent) {
+            input_post_event(INPUT_EVENT_SHORT_PRESS);
+        }
+    }
+}
+
+
+/**
+ * @brief Start the input task
+ * @param render_task Task to wake up on each event; it must run the effects.
+ */
+void input_init(TaskHandle_t render_task) {
+    s_render_task = render_task;
+
+    s_edges = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(bool));
+    if (!s_edges)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+    if (xTaskCreate(input_task, "input", INPUT_TASK_STACK_SIZE, NULL,
+                    INPUT_TASK_PRIORITY, NULL) != pdPASS)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+}
+
+
+/**
+ * @brief Queue a raw edge of the button, ISR context only
+ * @param pressed Level of the line after the edge.
+ */
+void input_edge_from_isr(bool pressed) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    // If the queue is full the line is bouncing anyway: the edge can be lost
+    xQueueSendFromISR(s_edges, &pressed, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+
+/**
+ * @brief Interrupt the current scenario with the given event
+ */
+void input_post_event(input_event_t event) {
+    ESP_LOGD(TAG, "event: %d", event);
+
+    s_pending_event = event;
+    g_button_pressed = true;
+
+    if (s_render_task)
+        xTaskNotifyGive(s_render_task);
+}
+
+
+/**
+ * @brief Get and clear the last event, from the rendering task
+ * The notification that may remain is also cleared, so that it doesn't
+ * abort the first frame of the next scenario.
+ */
+input_event_t input_take_event(void) {
+    input_event_t event = s_pending_event;
+
+    s_pending_event = INPUT_EVENT_NONE;
+    g_button_pressed = false;
+    ulTaskNotifyTake(pdTRUE, 0);
+    return event;
+}
@@ -0,0 +1,331 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Creation of the output channels on the RMT or SPI peripheral
+ */
+// Standard imports
+#include <stdlib.h>
+
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Espressif imports
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <nvs.h>
+#include <soc/soc_caps.h>
+
+// Local imports
+#include "include/led_backend.h"
+
+static const char *TAG = "LED_BACKEND";
+
+// 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
+#define LED_STRIP_RMT_RES_HZ            (10 * 1000 * 1000)
+// this determines the DMA block size
+#define LED_STRIP_DMA_BLOCK_WORDS       1024
+// let the driver choose a proper memory block size automatically
+// should be at least 64
+#define LED_STRIP_MEMORY_BLOCK_WORDS    0
+
+// Only one RMT channel can use the DMA feature, and this is a hardware limitation.
+// The RMT DMA is only available on chips e.g. ESP32-S3/P4 => not on C6
+#if SOC_RMT_SUPPORT_DMA
+#define RMT_DMA_CHANNELS    1
+#else
+#define RMT_DMA_CHANNELS    0
+#endif
+
+// Calibration of the CPU load measurement
+#define BENCH_IDLE_WINDOW_MS    50
+
+static const char *s_backend_names[LED_BACKEND_MAX] = { "RMT", "SPI", "RMT direct" };
+// Incremented by the benchmark task when the CPU has nothing else to do
+static volatile uint32_t s_spins;
+
+
+const char *led_backend_name(led_backend_t backend) {
+    return (backend < LED_BACKEND_MAX) ? s_backend_names[backend] : "?";
+}
+
+
+/**
+ * @brief Get the backend from the settings
+ * The NVS must be initialized.
+ */
+led_backend_t led_backend_load(void) {
+    nvs_handle_t handle;
+    uint8_t value = LED_BACKEND_DEFAULT;
+
+    if (nvs_open(LED_BACKEND_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u8(handle, LED_BACKEND_NVS_KEY, &value);
+        nvs_close(handle);
+    }
+    if (value >= LED_BACKEND_MAX) {
+        ESP_LOGW(TAG, "Unknown backend %d, using %s", value, led_backend_name(LED_BACKEND_DEFAULT));
+        value = LED_BACKEND_DEFAULT;
+    }
+    return value;
+}
+
+
+/**
+ * @brief Keep the backend for the next boots
+ */
+esp_err_t led_backend_save(led_backend_t backend) {
+    nvs_handle_t handle;
+
+    esp_err_t ret = nvs_open(LED_BACKEND_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK)
+        return ret;
+    ret = nvs_set_u8(handle, LED_BACKEND_NVS_KEY, backend);
+    if (ret == ESP_OK)
+        ret = nvs_commit(handle);
+    nvs_close(handle);
+    return ret;
+}
+
+
+/**
+ * @brief Configure the LED driver via the RMT (Remote Control Transceiver) peripheral
+ * Each call takes one RMT TX channel.
+ * @param gpio Data line of the strip
+ * @param with_dma Only one channel can use the DMA
+ * @return LED strip object
+ */
+led_strip_handle_t configure_led_rmt(gpio_num_t gpio, bool with_dma) {
+    // LED strip general initialization, according to your led board design
+    led_strip_config_t strip_config = {
+        .strip_gpio_num         = gpio,                              // The GPIO that connected to the LED strip's data line
+        .max_leds               = LED_CHANNEL_LED_COUNT,             // The number of LEDs in the strip,
+        .led_model              = LED_MODEL_WS2812,                  // LED strip model LED_MODEL_SK6812, LED_MODEL_WS2811, LED_MODEL_WS2812
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB, // The color order of the strip: GRB
+        .flags = {
+            .invert_out = false, // Don't invert the output signal
+        }
+    };
+
+    // LED strip backend configuration: RMT
+    // https://docs.espressif.com/projects/esp-idf/en/stable/esp32/api-reference/peripherals/rmt.html#install-rmt-tx-channel
+    led_strip_rmt_config_t rmt_config = {
+        .clk_src           = RMT_CLK_SRC_DEFAULT,  // Different clock source can lead to different power consumption
+        .resolution_hz     = LED_STRIP_RMT_RES_HZ, // RMT counter clock frequency
+        // The memory block size used by the RMT channel
+        .mem_block_symbols = with_dma ? LED_STRIP_DMA_BLOCK_WORDS : LED_STRIP_MEMORY_BLOCK_WORDS,
+        .flags = {
+            .with_dma = with_dma, // Using DMA can improve performance when driving more LEDs
+        }
+    };
+
+    // Create the LED strip object
+    led_strip_handle_t led_strip = NULL;
+
+    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip));
+    ESP_LOGI(TAG, "Created LED strip object with RMT backend");
+    return led_strip;
+}
+
+
+/**
+ * @brief Configure the LED driver via the SPI master driver
+ * There is only one SPI bus for the strips: only one handle at a time.
+ * @param gpio Data line of the strip
+ * @return LED strip object
+ */
+led_strip_handle_t configure_led_spi(gpio_num_t gpio) {
+    // LED strip common configuration
+    led_strip_config_t strip_config = {
+        .strip_gpio_num         = gpio,                              // The GPIO that connected to the LED strip's data line
+        .max_leds               = LED_CHANNEL_LED_COUNT,             // The number of LEDs in the strip,
+        .led_model              = LED_MODEL_WS2812,                  // LED strip model, it determines the bit timing
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB, // The color component format is GRB
+        .flags ={
+            .invert_out = false, // Don't invert the output signal
+        }
+    };
+
+    // SPI backend specific configuration
+    led_strip_spi_config_t spi_config = {
+        .clk_src = SPI_CLK_SRC_DEFAULT, // Different clock source can lead to different power consumption
+        .spi_bus = SPI2_HOST,           // SPI bus ID
+        .flags = {
+            .with_dma = true,  // Using DMA can improve performance and help drive more LEDs
+        }
+    };
+
+    // Create the LED strip object
+    led_strip_handle_t led_strip = NULL;
+
+    ESP_ERROR_CHECK(led_strip_new_spi_device(&strip_config, &spi_config, &led_strip));
+    ESP_LOGI(TAG, "Created LED strip object with SPI backend");
+    return led_strip;
+}
+
+
+/**
+ * @brief Create the driver of each channel (LED_STRIP_GPIOS) on the given backend
+ */
+void led_backend_create(led_backend_t backend, output_channel_t channels[LED_STRIP_CHANNELS]) {
+    const gpio_num_t gpios[LED_STRIP_CHANNELS] = LED_STRIP_GPIOS;
+    uint8_t rmt_dma_channels = RMT_DMA_CHANNELS;
+
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        channels[channel] = (output_channel_t){ 0 };
+        if (backend == LED_BACKEND_SPI && channel == 0) {
+            channels[channel].led_strip = configure_led_spi(gpios[channel]);
+            continue;
+        }
+        if (backend == LED_BACKEND_RMT_DIRECT)
+            ESP_ERROR_CHECK(frame_tx_new_rmt(gpios[channel], rmt_dma_channels > 0, &channels[channel].frame_tx));
+        else
+            channels[channel].led_strip = configure_led_rmt(gpios[channel], rmt_dma_channels > 0);
+        rmt_dma_channels = 0;
+    }
+    ESP_LOGI(TAG, "%d channel(s) of %d LEDs on the %s backend",
+             LED_STRIP_CHANNELS, LED_CHANNEL_LED_COUNT, led_backend_name(backend));
+}
+
+
+/**
+ * @brief Release the peripherals of the channels
+ */
+void led_backend_delete(output_channel_t channels[LED_STRIP_CHANNELS]) {
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        if (channels[channel].led_strip)
+            ESP_ERROR_CHECK(led_strip_del(channels[channel].led_strip));
+        else
+            ESP_ERROR_CHECK(frame_tx_del(channels[channel].frame_tx));
+        channels[channel] = (output_channel_t){ 0 };
+    }
+}
+
+
+/**
+ * @brief Count the iterations the CPU can spare, see led_backend_benchmark()
+ */
+static void spin_task(void *arg) {
+    (void) arg;
+
+    while (1)
+        s_spins++;
+}
+
+
+/**
+ * @brief Measure the refreshes of all the channels on the given backend
+ *
+ * A task of lower priority spins while the benchmark waits for the end of
+ * the transmissions: the spins missing compared to an idle window give the
+ * CPU time taken by the driver (encoding ISR of the RMT, SPI interrupts).
+ * It is suspended between the frames so that the idle task can run.
+ * Must be called before the output and the network are started.
+ * @param result Optional, the results are logged anyway
+ */
+void led_backend_benchmark(led_backend_t backend, uint16_t frames, led_backend_bench_t *result) {
+    output_channel_t channels[LED_STRIP_CHANNELS];
+    strip_stream_t streams[LED_STRIP_CHANNELS];
+    // Frame sent like the output does, without gamma correction
+    static uint16_t levels[256];
+    framebuffer_t *fb = calloc(1, sizeof(framebuffer_t));
+    uint8_t (*residues)[3] = calloc(LED_STRIP_LED_COUNT, 3);
+    if (!fb || !residues)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    for (uint16_t value = 0; value < 256; value++)
+        levels[value] = value << 8;
+    strip_levels_t strip_levels = { .levels = levels, .residues = residues, .scale = 1 << 16 };
+
+    led_backend_create(backend, channels);
+
+    // The spinner must only run when the benchmark is blocked
+    UBaseType_t priority = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 2);
+    TaskHandle_t spinner;
+    if (xTaskCreatePinnedToCore(spin_task, "led_bench_spin", 1024, NULL, tskIDLE_PRIORITY + 1,
+                                &spinner, xPortGetCoreID()) != pdPASS)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+    // Spins per ms with nothing else to do
+    s_spins = 0;
+    int64_t start = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(BENCH_IDLE_WINDOW_MS));
+    vTaskSuspend(spinner);
+    uint64_t idle_rate = (uint64_t) s_spins * 1000 / MAX_(1, esp_timer_get_time() - start);
+
+    uint64_t cycle_us = 0, latency_us = 0, call_us = 0, wait_us = 0, spins = 0;
+    for (uint16_t frame = 0; frame < frames; frame++) {
+        color_t *pixels = &fb->pixels[0][0][0];
+        for (pix_id_t i = 0; i < LED_STRIP_LED_COUNT; i++)
+            pixels[i] = (color_t){ .red = frame, .green = i, .blue = i >> 8 };
+
+        int64_t fill = esp_timer_get_time();
+        for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+            strip_stream_begin(&streams[channel], fb, &strip_levels,
+                               channel * LED_CHANNEL_LED_COUNT, LED_CHANNEL_LED_COUNT);
+            uint8_t grb[3];
+            for (pix_id_t index = 0; channels[channel].led_strip
+                 && strip_stream_read(&streams[channel], grb, 3) == 3; index++)
+                led_strip_set_pixel(channels[channel].led_strip, index, grb[1], grb[0], grb[2]);
+        }
+
+        s_spins = 0;
+        vTaskResume(spinner);
+        int64_t trigger = esp_timer_get_time();
+        for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+            if (channels[channel].led_strip)
+                ESP_ERROR_CHECK(led_strip_refresh_async(channels[channel].led_strip));
+            else
+                ESP_ERROR_CHECK(frame_tx_transmit(channels[channel].frame_tx, &streams[channel]));
+        }
+        int64_t triggered = esp_timer_get_time();
+        for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+            if (channels[channel].led_strip)
+                ESP_ERROR_CHECK(led_strip_refresh_wait_done(channels[channel].led_strip));
+            else
+                ESP_ERROR_CHECK(frame_tx_wait_done(channels[channel].frame_tx, NULL));
+        }
+        int64_t done = esp_timer_get_time();
+        vTaskSuspend(spinner);
+
+        cycle_us += done - fill;
+        latency_us += done - trigger;
+        call_us += triggered - trigger;
+        wait_us += done - triggered;
+        spins += s_spins;
+        // Feed the idle task
+        vTaskDelay(1);
+    }
+
+    vTaskDelete(spinner);
+    vTaskPrioritySet(NULL, priority);
+    led_backend_delete(channels);
+    free(residues);
+    free(fb);
+
+    uint64_t expected_spins = MAX_(1, idle_rate * wait_us / 1000);
+    led_backend_bench_t current = {
+        .latency_us = latency_us / MAX_(1, frames),
+        .call_us    = call_us / MAX_(1, frames),
+        .cpu_busy   = (spins < expected_spins) ? 100 - spins * 100 / expected_spins : 0,
+        .max_fps    = (uint64_t) frames * 1000000 / MAX_(1, cycle_us),
+    };
+    ESP_LOGI(TAG, "%s: %d LEDs x %d channel(s): refresh %" PRIu32 " us (call %" PRIu32 " us), "
+             "CPU busy %d%% during the transmission, %" PRIu32 " FPS max",
+             led_backend_name(backend), LED_CHANNEL_LED_COUNT, LED_STRIP_CHANNELS,
+             current.latency_us, current.call_us, current.cpu_busy, current.max_fps);
+    if (result)
+        *result = current;
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Live content received from a show controller over the network (DDP)
+ */
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/live.h"
+#include "include/ddp.h"
+
+static const char *TAG = "LIVE";
+
+// Polling rate of the receiver: frames are shown at most one period after their push
+#define LIVE_FPS    250
+
+typedef struct {
+    ddp_receiver_t receiver;
+    bool listening;
+    bool pending;   // The framebuffer holds the changes of an unfinished frame
+} live_state_t;
+
+
+void live_init(void *state, const void *config) {
+    (void) config;
+    live_state_t *live = state;
+
+    live->listening = ddp_open(&live->receiver, DDP_PORT) == ESP_OK;
+}
+
+
+/**
+ * @brief Show the last pushed frame
+ * The packets of the next frame stay in the socket until the next step.
+ * An unfinished frame is not presented: its changes are hidden from the
+ * output (dirty flag) until its push.
+ */
+void live_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    (void) dt_ms;
+    live_state_t *live = state;
+
+    if (!live->listening)
+        return;
+
+    // Changes made before this step (initial clear) are presented anyway
+    bool dirty = fb->dirty;
+    fb->dirty = false;
+    bool pushed = ddp_poll(&live->receiver, fb);
+    live->pending |= fb->dirty;
+    fb->dirty = dirty;
+
+    if (pushed) {
+        fb->dirty |= live->pending;
+        live->pending = false;
+    }
+}
+
+
+void live_teardown(void *state) {
+    live_state_t *live = state;
+    const ddp_stats_t *stats = &live->receiver.stats;
+
+    ESP_LOGI(TAG, "frames: %" PRIu32 ", packets: %" PRIu32 ", late: %" PRIu32 ", invalid: %" PRIu32,
+             stats->frames, stats->packets, stats->late, stats->invalid);
+    ddp_close(&live->receiver);
+}
+
+
+const effect_t g_live_effect = {
+    .name       = "live",
+    .fps        = LIVE_FPS,
+    .state_size = sizeof(live_state_t),
+    .init       = live_init,
+    .step       = live_step,
+    .teardown   = live_teardown,
+};
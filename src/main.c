@@ -24,153 +24,109 @@
 #include <esp_log.h>
 #include <driver/gpio.h>
 #include <rom/gpio.h>  // gpio_output_set
-#include <driver/rmt_tx.h>
+#ifdef WIFI_SSID
+#include <esp_event.h>
+#include <esp_netif.h>
+#include <esp_wifi.h>
+#endif
+#include <nvs_flash.h>
 
 #include "led_strip.h"
 
 // Local imports
 #include "include/commons.h"
-#include "include/base.h"
-#include "include/rainbow.h"
-#include "include/random.h"
-#include "include/fire.h"
-#include "include/matrix.h"
-
-
-/** RMT / SPI driver configuration **/
-
-#if LED_STRIP_USE_DMA
-// Numbers of the LED in the strip
-// #define LED_STRIP_LED_COUNT 256
-#define LED_STRIP_MEMORY_BLOCK_WORDS    1024 // this determines the DMA block size
-#else
-// Numbers of the LED in the strip
-// #define LED_STRIP_LED_COUNT 24
-// let the driver choose a proper memory block size automatically
-// should be at least 64
-#define LED_STRIP_MEMORY_BLOCK_WORDS    0
-#endif  // LED_STRIP_USE_DMA
-
-// 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
-#define LED_STRIP_RMT_RES_HZ    (10 * 1000 * 1000)
-
-bool g_button_pressed = false;
-uint8_t g_side2;
-uint8_t g_side3;
+#include "include/mapping.h"
+#include "include/output.h"
+#include "include/input.h"
+#include "include/engine.h"
+#include "include/registry.h"
+#include "include/serial_link.h"
+#include "include/led_backend.h"
+
+
+#define BUTTON_GPIO    GPIO_NUM_9  // BOOT button, active low
 
 static const char *TAG = "LED_CUBE";
 
 /**
  * @brief ISR for a BOOT button status change
+ * Debouncing & press detection are done by the input task.
  */
 void IRAM_ATTR isr_handler(void *arg) {
-    if (g_button_pressed)
-        return;
-
-    g_button_pressed = true;
-
-    // Will get set to pdTRUE inside the interrupt safe
-    // API function if a context switch is required.
-    // BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-
-    // Notification of an incoming event
-    // vTaskNotifyGiveFromISR(xTaskHandle, &xHigherPriorityTaskWoken);
-
-    /* If xHigherPriorityTaskWoken is now set to pdTRUE then a context switch
-     * is performed to ensure the interrupt returns directly to the highest
-     * priority task. */
-    // portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    input_edge_from_isr(gpio_get_level(BUTTON_GPIO) == 0);
 }
 
 
 /**
- * @brief Configure the LED driver via the RMT (Remote Control Transceiver) peripheral
- * @return LED strip object
+ * @brief Use Boot button to change the scenario
  */
-led_strip_handle_t configure_led_rmt(void) {
-    // LED strip general initialization, according to your led board design
-    led_strip_config_t strip_config = {
-        .strip_gpio_num         = LED_STRIP_GPIO,                    // The GPIO that connected to the LED strip's data line
-        .max_leds               = LED_STRIP_LED_COUNT,               // The number of LEDs in the strip,
-        .led_model              = LED_MODEL_WS2812,                  // LED strip model LED_MODEL_SK6812, LED_MODEL_WS2811, LED_MODEL_WS2812
-        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB, // The color order of the strip: GRB
-        .flags = {
-            .invert_out = false, // Don't invert the output signal
-        }
-    };
-
-    // LED strip backend configuration: RMT
-    // https://docs.espressif.com/projects/esp-idf/en/stable/esp32/api-reference/peripherals/rmt.html#install-rmt-tx-channel
-    led_strip_rmt_config_t rmt_config = {
-        .clk_src           = RMT_CLK_SRC_DEFAULT,          // Different clock source can lead to different power consumption
-        .resolution_hz     = LED_STRIP_RMT_RES_HZ,         // RMT counter clock frequency
-        .mem_block_symbols = LED_STRIP_MEMORY_BLOCK_WORDS, // The memory block size used by the RMT channel
-        .flags = {
-            // Only one RMT channel can use the DMA feature, and this is a hardware limitation.
-            // Thus, only one led_strip handle can utilize the DMA ability.
-            .with_dma = LED_STRIP_USE_DMA, // Using DMA can improve performance when driving more LEDs
-        }
+void configure_button(void) {
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << BUTTON_GPIO),
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_ANYEDGE,  // Press & release (long press detection)
     };
 
-    // Create the LED strip object
-    led_strip_handle_t led_strip = NULL;
-
-    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip));
-    ESP_LOGI(TAG, "Created LED strip object with RMT backend");
-    return led_strip;
+    gpio_config(&io_conf);
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(BUTTON_GPIO, isr_handler, NULL);
 }
 
 
 /**
- * @brief Configure the LED driver via the SPI master driver
- * @return LED strip object
+ * @brief Initialize the NVS, used by the settings and the Wi-Fi driver
  */
-led_strip_handle_t configure_led_spi(void) {
-    // LED strip common configuration
-    led_strip_config_t strip_config = {
-        .strip_gpio_num         = LED_STRIP_GPIO,                    // The GPIO that connected to the LED strip's data line
-        .max_leds               = LED_STRIP_LED_COUNT,               // The number of LEDs in the strip,
-        .led_model              = LED_MODEL_WS2812,                  // LED strip model, it determines the bit timing
-        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB, // The color component format is GRB
-        .flags ={
-            .invert_out = false, // Don't invert the output signal
-        }
-    };
+void configure_nvs(void) {
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+}
 
-    // SPI backend specific configuration
-    led_strip_spi_config_t spi_config = {
-        .clk_src = SPI_CLK_SRC_DEFAULT, // Different clock source can lead to different power consumption
-        .spi_bus = SPI2_HOST,           // SPI bus ID
-        .flags = {
-            .with_dma = true,  // Using DMA can improve performance and help drive more LEDs
-        }
-    };
 
-    // Create the LED strip object
-    led_strip_handle_t led_strip = NULL;
+#ifdef WIFI_SSID
+/**
+ * @brief Reconnect the station when the connection is lost
+ */
+void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    (void) arg;
+    (void) event_data;
 
-    ESP_ERROR_CHECK(led_strip_new_spi_device(&strip_config, &spi_config, &led_strip));
-    ESP_LOGI(TAG, "Created LED strip object with SPI backend");
-    return led_strip;
+    if (event_base == WIFI_EVENT && (event_id == WIFI_EVENT_STA_START
+                                     || event_id == WIFI_EVENT_STA_DISCONNECTED))
+        esp_wifi_connect();
 }
 
 
 /**
- * @brief Use Boot button to change the scenario
+ * @brief Connect to the access point WIFI_SSID, in the background
  */
-void configure_button(void) {
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << GPIO_NUM_9),
-        .mode         = GPIO_MODE_INPUT,
-        .pull_up_en   = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type    = GPIO_INTR_NEGEDGE,  // React on falling edge
+void configure_wifi(void) {
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    esp_netif_create_default_wifi_sta();
+
+    wifi_init_config_t init_config = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&init_config));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_event_handler, NULL));
+
+    wifi_config_t wifi_config = {
+        .sta = {
+            .ssid     = WIFI_SSID,
+            .password = WIFI_PASSWORD,
+        },
     };
-
-    gpio_config(&io_conf);
-    gpio_install_isr_service(0);
-    gpio_isr_handler_add(GPIO_NUM_9, isr_handler, NULL);
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    // Power saving delays the packets by up to a DTIM period
+    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
+    ESP_ERROR_CHECK(esp_wifi_start());
 }
+#endif
 
 
 /**
@@ -228,53 +184,46 @@ void test_gpios(void) {
 
 
 void app_main(void) {
+    // Button events interrupt the effects running in this task
+    input_init(xTaskGetCurrentTaskHandle());
     configure_button();
 
-    g_side2 = SIDE_LENGTH * SIDE_LENGTH;
-    g_side3 = g_side2 * SIDE_LENGTH;
+    build_pix_map(&g_cubebit_wiring);
 
     ESP_LOGI(TAG, "Initialisation of the LED cube driver...");
-    led_strip_handle_t led_strip = configure_led_rmt();
-    // led_strip_handle_t led_strip = configure_led_spi();
+    configure_nvs();
+#ifdef LED_BENCHMARK
+    for (led_backend_t backend = 0; backend < LED_BACKEND_MAX; backend++)
+        led_backend_benchmark(backend, LED_BACKEND_BENCH_FRAMES, NULL);
+#endif
+    output_channel_t channels[LED_STRIP_CHANNELS];
+    led_backend_create(led_backend_load(), channels);
+    output_init(channels);
+
+#ifdef WIFI_SSID
+    configure_wifi();
+#endif
+#ifdef SERIAL_STREAMING
+    serial_link_init();
+#endif
 
     uint8_t scenario = 4;
     while (1) {
         ESP_LOGI(TAG, "scenario: %d", scenario);
 
-        switch (scenario) {
-            case 0:
-                base(&led_strip);
+        switch (engine_run(g_effects[scenario])) {
+            case INPUT_EVENT_SHORT_PRESS:
+                // Next scenario
+                scenario = (scenario + 1) % g_effect_count;
                 break;
 
-            case 1:
-                rainbow(&led_strip);
-                break;
-
-            case 2:
-                randomisation(&led_strip);
-                break;
-
-            case 3:
-                // Red fire
-                fire(&led_strip, true);
-                break;
-
-            case 4:
-                // Green fire
-                fire(&led_strip, false);
-                break;
-
-            case 5:
-                matrix(&led_strip);
+            case INPUT_EVENT_LONG_PRESS:
+                // Previous scenario
+                scenario = (scenario + g_effect_count - 1) % g_effect_count;
                 break;
 
             default:
-                scenario = 0;
-        }
-
-        if (g_button_pressed) {
-            g_button_pressed = false;
-            scenario++;
+                break;
         }
     }
 }
@@ -0,0 +1,98 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Lookup tables between the cube coordinates and the led strip indexes
+ */
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/mapping.h"
+
+static const char *TAG = "MAPPING";
+
+/*
+ * Even planes: lines along x, from y = 0 to y = SIDE_LENGTH - 1.
+ * Odd planes: lines along y, from x = SIDE_LENGTH - 1 to x = 0;
+ * the first one starts at y = SIDE_LENGTH - 1.
+ */
+const cube_wiring_t g_cubebit_wiring = {
+    .even_plane = {
+        .line_axis      = AXIS_X,
+        .line_reversed  = false,
+        .stack_reversed = false,
+    },
+    .odd_plane = {
+        .line_axis      = AXIS_Y,
+        .line_reversed  = true,
+        .stack_reversed = true,
+    },
+    .serpentine = true,
+    .flip_x     = false,
+    .flip_y     = false,
+    .flip_z     = false,
+};
+
+pix_id_t g_pix_map[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];
+voxel_t g_voxel_map[LED_STRIP_LED_COUNT];
+voxel_t g_frame_map[LED_STRIP_LED_COUNT];
+
+
+/**
+ * @brief Follow the strip across the cube and fill the lookup tables
+ * The frames are shown as they are until a view is applied.
+ */
+void build_pix_map(const cube_wiring_t *wiring) {
+    uint8_t last = SIDE_LENGTH - 1;
+    pix_id_t id = 0;
+
+    for (uint8_t plane = 0; plane < SIDE_LENGTH; plane++) {
+        // Each channel starts over with an even plane
+        uint8_t channel_plane = plane % (SIDE_LENGTH / LED_STRIP_CHANNELS);
+        const plane_wiring_t *plane_wiring = (channel_plane % 2) ? &wiring->odd_plane : &wiring->even_plane;
+
+        for (uint8_t line = 0; line < SIDE_LENGTH; line++) {
+            uint8_t stack_pos = plane_wiring->stack_reversed ? last - line : line;
+            bool backwards = plane_wiring->line_reversed ^ (wiring->serpentine && (line % 2));
+
+            for (uint8_t step = 0; step < SIDE_LENGTH; step++) {
+                uint8_t line_pos = backwards ? last - step : step;
+                voxel_t voxel;
+
+                if (plane_wiring->line_axis == AXIS_X) {
+                    voxel.x = line_pos;
+                    voxel.y = stack_pos;
+                } else {
+                    voxel.x = stack_pos;
+                    voxel.y = line_pos;
+                }
+                voxel.z = plane;
+
+                if (wiring->flip_x)
+                    voxel.x = last - voxel.x;
+                if (wiring->flip_y)
+                    voxel.y = last - voxel.y;
+                if (wiring->flip_z)
+                    voxel.z = last - voxel.z;
+
+                g_pix_map[voxel.x][voxel.y][voxel.z] = id;
+                g_voxel_map[id] = voxel;
+                g_frame_map[id] = voxel;
+                id++;
+            }
+        }
+    }
+    ESP_LOGD(TAG, "Mapping built for %d LEDs on %d channel(s)", id, LED_STRIP_CHANNELS);
+}
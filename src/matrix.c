@@ -15,19 +15,26 @@
 /**
  * @brief Matrix raining code animation
  */
-// Standard imports
-#include <string.h>  // memset
-
 // Espressif imports
 #include <esp_log.h>
 
 // Local imports
 #include "include/matrix.h"
 #include "include/commons.h"
+#include "include/prng.h"
 
 static const char *TAG = "MATRIX";
 
+#define MATRIX_FPS    7  // Target frame rate, ~150ms per frame
+
+typedef struct {
+    prng_t rng;
+    uint8_t cells[SIDE_LENGTH][SIDE_LENGTH][SIDE_LENGTH];  // Color index of each cell, (x,y,z) order
+} matrix_state_t;
+
 enum matrix_green { MATRIX_ZERO, MATRIX_ONE, MATRIX_TWO, MATRIX_THREE, MATRIX_FOUR, MATRIX_FIVE, MATRIX_MAX, MATRIX_INVALID };
+// Perceptual values (gamma corrected by the output): each step is ~4 times
+// less light than the previous one
 color_t matrix_colors[MATRIX_INVALID] = {
     {
         .red = 0,
@@ -35,34 +42,34 @@ color_t matrix_colors[MATRIX_INVALID] = {
         .blue = 0,
     },
     {
-        .red = 0,  // 0x0D,
-        .green = 0x01,
-        .blue = 0x00,  // 0x08,  // Can't add anything other than green to avoid redish color
+        .red = 0,
+        .green = 0x15,
+        .blue = 0x00,  // Can't add anything other than green to avoid redish color
     },
     {
         .red = 0x00,
-        .green = 0x03,  // Divide previous val by 4
+        .green = 0x22,
         .blue = 0x00,
     },
     {
         .red = 0x00,
-        .green = 0x0E,  // Divide previous val by 4
+        .green = 0x44,
         .blue = 0x00,
     },
     {
         .red = 0x00,
-        .green = 0x3B,
+        .green = 0x83,
         .blue = 0x00,
     },
     {
         .red = 0x00,
-        .green = 0x8F,
-        .blue = 0x11,
+        .green = 0xC4,
+        .blue = 0x4A,
     },
     {
         .red = 0x00,
         .green = 0xFF,
-        .blue = 0x41,
+        .blue = 0x89,
     }
 };
 
@@ -72,8 +79,8 @@ color_t matrix_colors[MATRIX_INVALID] = {
  * Each color is defined by its unique id in the 3D array.
  * The colors gradually fade away on the lowest cell.
  */
-void raining_code(led_strip_handle_t *led_strip, uint8_t col, uint8_t y) {
-    uint8_t (*strand)[SIDE_LENGTH] = &g_cube[col][y];
+void raining_code(matrix_state_t *matrix, framebuffer_t *fb, uint8_t col, uint8_t y) {
+    uint8_t (*strand)[SIDE_LENGTH] = &matrix->cells[col][y];
 
     // Init new rain only if all cells of the strand are disabled
     bool activated_cells = false;
@@ -88,7 +95,7 @@ void raining_code(led_strip_handle_t *led_strip, uint8_t col, uint8_t y) {
     if (!activated_cells) {
         // Enable the current (empty) strand with ~5% of chance
         // Enabling a strand consists of setting the maximum color to the top led of it
-        uint8_t draw = (rand() % 101);
+        uint8_t draw = prng_below(&matrix->rng, 101);
         if (draw > 5) {
             return;
         }
@@ -99,9 +106,7 @@ void raining_code(led_strip_handle_t *led_strip, uint8_t col, uint8_t y) {
         // Set the color immediately
         color_t color = matrix_colors[MATRIX_MAX];
         // ESP_LOGD(TAG, "Rain enabled: red: %d, green: %d; blue: %d", color.red, color.green, color.blue);
-#ifndef PIO_QEMU_ENV
-        led_strip_set_pixel(*led_strip, get_pix_id(col, y, SIDE_LENGTH - 1), color.red, color.green, color.blue);
-#endif
+        fb_set_pixel(fb, col, y, SIDE_LENGTH - 1, color);
         return;
     } else {
         ESP_LOGD(TAG, "Rain already enabled: x: %d, y: %d", col, y);
@@ -128,44 +133,49 @@ void raining_code(led_strip_handle_t *led_strip, uint8_t col, uint8_t y) {
     for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
         uint8_t color_idx = (*strand)[z];
         color_t color = matrix_colors[color_idx];
-#ifndef PIO_QEMU_ENV
-        led_strip_set_pixel(*led_strip, get_pix_id(col, y, z), color.red, color.green, color.blue);
-#endif
+        fb_set_pixel(fb, col, y, z, color);
     }
 }
 
 
-/**
- * @brief Entry point for the Matrix raining code effect
- */
-void matrix(led_strip_handle_t *led_strip) {
-    ESP_LOGI(TAG, "Animation: matrix");
+void matrix_init(void *state, const void *config) {
+    (void) config;
+    matrix_state_t *matrix = state;
 
-#ifndef PIO_QEMU_ENV
-    ESP_ERROR_CHECK(led_strip_clear(*led_strip));
-#endif
+    // Seed the generator
+    prng_init(&matrix->rng);
+}
 
-    // Clear buffer
-    memset(g_cube, 0, sizeof(uint8_t) * SIDE_LENGTH * SIDE_LENGTH * SIDE_LENGTH);
 
-    // Seed rand
-    srand(esp_random());
+/**
+ * @brief Step of the Matrix raining code effect
+ */
+void matrix_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    (void) dt_ms;
 
-    while (1) {
-        for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
-            for (uint8_t col = 0; col < SIDE_LENGTH; col++) {
-                raining_code(led_strip, col, y);
-                // ESP_LOGI(TAG, "end strand");
-            }
+    for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
+        for (uint8_t col = 0; col < SIDE_LENGTH; col++) {
+            raining_code(state, fb, col, y);
+            // ESP_LOGI(TAG, "end strand");
         }
+    }
+}
 
-#ifndef PIO_QEMU_ENV
-        ESP_ERROR_CHECK(led_strip_refresh(*led_strip));
-#endif
 
-        if (g_button_pressed)
-            break;
+const effect_t g_matrix_effect = {
+    .name       = "matrix",
+    .fps        = MATRIX_FPS,
+    .state_size = sizeof(matrix_state_t),
+    .init       = matrix_init,
+    .step       = matrix_step,
+};
 
-        vTaskDelay(pdMS_TO_TICKS(150));
-    }
-}
+// Same rain, falling along -x: quarter turn around the Y axis
+const effect_t g_matrix_side_effect = {
+    .name       = "matrix_side",
+    .fps        = MATRIX_FPS,
+    .state_size = sizeof(matrix_state_t),
+    .view       = &(const view_t){ .m = { { 0, 0, 1 }, { 0, 1, 0 }, { -1, 0, 0 } } },
+    .init       = matrix_init,
+    .step       = matrix_step,
+};
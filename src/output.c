@@ -0,0 +1,399 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Double-buffered output to the LED strip
+ *
+ * Effects render into the back buffer then call output_present().
+ * The buffers are swapped and a dedicated task pushes the front buffer
+ * to the strip while the next frame is being rendered.
+ *
+ * The transmit task only holds the front buffer while copying it into
+ * the driver; the buffer is released before the (blocking) refresh.
+ * Thus the frame rate is max(compute, transmit) instead of their sum.
+ * Channels driven by a frame_tx have no copy: the front buffer is read
+ * during the transmission, and released at its end.
+ *
+ * With several channels (LED_STRIP_CHANNELS), the strips are refreshed
+ * together: the transmit time is the one of the slowest channel, i.e.
+ * of a strip of LED_CHANNEL_LED_COUNT LEDs.
+ *
+ * The framebuffer tracks the changes: presenting a frame identical to the
+ * previous one costs nothing. The engine presents once per frame clock
+ * tick, however many pixels the effect changed.
+ *
+ * The framebuffer values are perceptual: gamma correction and the global
+ * brightness are applied on the way to the strip (see strip_stream.h)
+ * through a LUT giving 8.8 fixed-point strip levels. The fractional part is
+ * spread over the next frames by temporal dithering (per-channel error
+ * accumulation), which recovers the low levels an 8-bit strip can't display.
+ *
+ * The current of each presented frame is estimated from the light sums
+ * maintained by the framebuffer; above the budget, the frame is scaled
+ * down in the same pass.
+ */
+// Standard imports
+#include <math.h>  // powf
+#include <string.h>  // memcpy, memset
+
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+// Espressif imports
+#include <esp_log.h>
+#include <esp_timer.h>
+
+// Local imports
+#include "include/output.h"
+#include "include/strip_stream.h"
+
+static const char *TAG = "OUTPUT";
+
+static framebuffer_t s_buffers[2];
+static framebuffer_t *s_front = &s_buffers[0];
+static framebuffer_t *s_back = &s_buffers[1];
+
+static output_channel_t s_channels[LED_STRIP_CHANNELS];
+// Bytes of each channel, from the front buffer
+static strip_stream_t s_streams[LED_STRIP_CHANNELS];
+static TaskHandle_t s_output_task;
+// Given when the transmit task has copied the front buffer
+static SemaphoreHandle_t s_front_free;
+// Held by the transmit task from the copy to the end of the refresh
+static SemaphoreHandle_t s_wire_lock;
+
+static output_stats_t s_stats;
+
+#define SCALE_ONE    65536  // No limiting, Q16
+
+uint16_t g_light_levels[256];
+// Strip level of each framebuffer value, 8.8 fixed point
+static uint16_t s_levels[256];
+static uint8_t s_brightness;
+static uint32_t s_budget_ma = OUTPUT_CURRENT_BUDGET_MA;
+// Current limiting of the front buffer, Q16
+static uint32_t s_front_scale = SCALE_ONE;
+// Fractional part carried over to the next frame, per strip LED and channel
+static uint8_t s_residues[LED_STRIP_LED_COUNT][3];
+static strip_levels_t s_strip_levels = {
+    .levels   = s_levels,
+    .residues = s_residues,
+    .scale    = SCALE_ONE,
+};
+static volatile bool s_dithering = true;
+// The last transmitted frame had levels between two strip values
+static volatile bool s_dither_pending = false;
+
+
+/**
+ * @brief Fill the gamma LUT of the framebuffer light sums
+ */
+void build_light_levels(void) {
+    for (uint16_t value = 0; value < 256; value++) {
+        g_light_levels[value] = (uint16_t) lroundf(powf(value / 255.0f, OUTPUT_GAMMA) * 65535);
+    }
+}
+
+
+/**
+ * @brief Fill the levels LUT for the given brightness
+ */
+void build_levels(uint8_t brightness) {
+    for (uint16_t value = 0; value < 256; value++) {
+        // 255.0 * 256 max: the residue can always be added without overflow
+        s_levels[value] = (g_light_levels[value] * brightness * 256U + 32767) / 65535;
+    }
+    s_brightness = brightness;
+}
+
+
+/**
+ * @brief Estimate the current of a frame
+ */
+uint32_t estimate_current_ua(const framebuffer_t *fb) {
+    uint64_t channels = (uint64_t) fb->light[0] * OUTPUT_RED_UA
+                      + (uint64_t) fb->light[1] * OUTPUT_GREEN_UA
+                      + (uint64_t) fb->light[2] * OUTPUT_BLUE_UA;
+
+    return channels * s_brightness / (65535U * 255U) + LED_STRIP_LED_COUNT * OUTPUT_IDLE_UA;
+}
+
+
+/**
+ * @brief Get the scale that fits the frame in the current budget, Q16
+ */
+uint32_t limit_current(uint32_t current_ua) {
+    uint32_t budget_ua = s_budget_ma * 1000;
+    uint32_t idle_ua = LED_STRIP_LED_COUNT * OUTPUT_IDLE_UA;
+
+    if (current_ua <= budget_ua)
+        return SCALE_ONE;
+    // The idle current can't be reduced
+    if (budget_ua <= idle_ua)
+        return 0;
+    return (uint64_t) (budget_ua - idle_ua) * SCALE_ONE / (current_ua - idle_ua);
+}
+
+
+/**
+ * @brief Copy the stream of the channel into its led_strip driver
+ */
+static void copy_to_strip(uint8_t channel) {
+    uint8_t grb[3];
+
+    for (pix_id_t index = 0; strip_stream_read(&s_streams[channel], grb, 3) == 3; index++)
+        led_strip_set_pixel(s_channels[channel].led_strip, index, grb[1], grb[0], grb[2]);
+}
+
+
+/**
+ * @brief Give the front buffer back to the renderer
+ */
+static void release_front(void) {
+    uint8_t fractions = 0;
+
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++)
+        fractions |= s_streams[channel].fractions;
+    s_dither_pending = s_strip_levels.dither && fractions;
+    xSemaphoreGive(s_front_free);
+}
+
+
+/**
+ * @brief Start the transmission of all the channels, then wait for each one
+ *
+ * The frame_tx channels time stamp their end from the RMT ISR; the led_strip
+ * driver has no such hook nor a non-blocking check, its channels end when
+ * their wait returns.
+ */
+static void refresh_channels(void) {
+    int64_t start_us[LED_STRIP_CHANNELS];
+
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        start_us[channel] = esp_timer_get_time();
+        if (s_channels[channel].led_strip)
+            ESP_ERROR_CHECK(led_strip_refresh_async(s_channels[channel].led_strip));
+        else
+            ESP_ERROR_CHECK(frame_tx_transmit(s_channels[channel].frame_tx, &s_streams[channel]));
+    }
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        int64_t done_us;
+        if (s_channels[channel].led_strip) {
+            ESP_ERROR_CHECK(led_strip_refresh_wait_done(s_channels[channel].led_strip));
+            done_us = esp_timer_get_time();
+        } else {
+            ESP_ERROR_CHECK(frame_tx_wait_done(s_channels[channel].frame_tx, &done_us));
+        }
+        uint32_t elapsed_us = done_us - start_us[channel];
+        s_stats.transmit_us[channel] = elapsed_us;
+        s_stats.transmit_peak_us[channel] = MAX_(s_stats.transmit_peak_us[channel], elapsed_us);
+    }
+}
+
+
+/**
+ * @brief Transmit task: wait for a new front buffer and push it to the strips
+ */
+static void output_task(void *arg) {
+    (void) arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(s_wire_lock, portMAX_DELAY);
+
+#ifndef PIO_QEMU_ENV
+        s_strip_levels.scale = s_front_scale;
+        s_strip_levels.dither = s_dithering;
+        bool zero_copy = false;
+        for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+            strip_stream_begin(&s_streams[channel], s_front, &s_strip_levels,
+                               channel * LED_CHANNEL_LED_COUNT, LED_CHANNEL_LED_COUNT);
+            if (s_channels[channel].led_strip)
+                copy_to_strip(channel);
+            else
+                zero_copy = true;
+        }
+
+        // The led_strip drivers have their own copy, the renderer can take the buffer back;
+        // the frame_tx ones read it until the end of the transmission
+        if (!zero_copy)
+            release_front();
+        refresh_channels();
+        if (zero_copy)
+            release_front();
+#else
+        xSemaphoreGive(s_front_free);
+#endif
+        xSemaphoreGive(s_wire_lock);
+    }
+}
+
+
+/**
+ * @brief Create the buffers and start the transmit task
+ */
+void output_init(const output_channel_t channels[LED_STRIP_CHANNELS]) {
+    memcpy(s_channels, channels, sizeof(s_channels));
+    build_light_levels();
+    build_levels(OUTPUT_BRIGHTNESS_DEFAULT);
+
+    s_front_free = xSemaphoreCreateBinary();
+    s_wire_lock = xSemaphoreCreateMutex();
+    if (!s_front_free || !s_wire_lock)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+    xSemaphoreGive(s_front_free);
+
+    if (xTaskCreate(output_task, "led_output", OUTPUT_TASK_STACK_SIZE, NULL,
+                    OUTPUT_TASK_PRIORITY, &s_output_task) != pdPASS)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+    ESP_LOGI(TAG, "Output task started");
+}
+
+
+/**
+ * @brief Scale all the LEDs, 255: full brightness
+ * The current frame is sent again with the new brightness on the next present.
+ */
+void output_set_brightness(uint8_t brightness) {
+    xSemaphoreTake(s_wire_lock, portMAX_DELAY);
+    build_levels(brightness);
+    xSemaphoreGive(s_wire_lock);
+    s_back->dirty = true;
+}
+
+
+/**
+ * @brief Enable the temporal dithering, or round the levels to the nearest strip value
+ * Dithering needs a high frame rate (see OUTPUT_DITHER_MIN_FPS).
+ */
+void output_set_dithering(bool enabled) {
+    s_dithering = enabled;
+}
+
+
+/**
+ * @brief Forget the dithering errors accumulated by the previous frames
+ * Waits for the end of the transmission: the residues are updated while
+ * the frame is sent.
+ */
+void output_reset_dithering(void) {
+    xSemaphoreTake(s_front_free, portMAX_DELAY);
+    xSemaphoreTake(s_wire_lock, portMAX_DELAY);
+    memset(s_residues, 0, sizeof(s_residues));
+    s_dither_pending = false;
+    xSemaphoreGive(s_wire_lock);
+    xSemaphoreGive(s_front_free);
+}
+
+
+/**
+ * @brief Set the maximum current of the frames, in mA
+ */
+void output_set_current_budget(uint32_t budget_ma) {
+    s_budget_ma = budget_ma;
+    s_back->dirty = true;
+}
+
+
+/**
+ * @brief Get the buffer in which the next frame must be rendered
+ */
+framebuffer_t *output_get_back_buffer(void) {
+    return s_back;
+}
+
+
+/**
+ * @brief Send the back buffer to the strip
+ *
+ * Only waits for the transmit task to pick up the previous frame, not for
+ * the end of its transmission.
+ * The new back buffer starts with the content of the presented frame,
+ * so the effects can update only some pixels like with the led_strip API.
+ * Nothing is sent if the back buffer wasn't modified, unless the
+ * dithering of the previous frame isn't finished.
+ * @return The new back buffer
+ */
+framebuffer_t *output_present(void) {
+    if (!s_back->dirty) {
+        if (!s_dither_pending) {
+            s_stats.unchanged++;
+            return s_back;
+        }
+        // Same frame, next dithering step: the front buffer is sent again
+        xSemaphoreTake(s_front_free, portMAX_DELAY);
+        s_stats.dithered++;
+        xTaskNotifyGive(s_output_task);
+        return s_back;
+    }
+
+    uint32_t current_ua = estimate_current_ua(s_back);
+    uint32_t scale = limit_current(current_ua);
+    s_stats.current_ma = current_ua / 1000;
+    s_stats.peak_ma = MAX_(s_stats.peak_ma, s_stats.current_ma);
+    if (scale < SCALE_ONE)
+        s_stats.limited++;
+
+    xSemaphoreTake(s_front_free, portMAX_DELAY);
+
+    s_front_scale = scale;
+    framebuffer_t *presented = s_back;
+    s_back = s_front;
+    s_front = presented;
+    // The transmit task only reads the front buffer: both can access it
+    memcpy(s_back, s_front, sizeof(framebuffer_t));
+    s_back->dirty = false;
+    s_stats.transmitted++;
+
+    xTaskNotifyGive(s_output_task);
+    return s_back;
+}
+
+
+/**
+ * @brief Wait for the end of the transmission of all the presented frames
+ */
+void output_flush(void) {
+    xSemaphoreTake(s_front_free, portMAX_DELAY);
+    xSemaphoreTake(s_wire_lock, portMAX_DELAY);
+    xSemaphoreGive(s_wire_lock);
+    xSemaphoreGive(s_front_free);
+}
+
+
+void output_get_stats(output_stats_t *stats) {
+    *stats = s_stats;
+}
+
+
+void output_reset_stats(void) {
+    s_stats = (output_stats_t){ 0 };
+}
+
+
+/**
+ * @brief Log the transmitted frames and the transmit time of each channel
+ */
+void output_log_stats(void) {
+    ESP_LOGI(TAG, "%" PRIu32 " frames sent, %" PRIu32 " unchanged, %" PRIu32 " dithered, peak %" PRIu32 " mA",
+             s_stats.transmitted, s_stats.unchanged, s_stats.dithered, s_stats.peak_ma);
+    for (uint8_t channel = 0; channel < LED_STRIP_CHANNELS; channel++) {
+        ESP_LOGI(TAG, "channel %d: transmit %" PRIu32 " us, peak %" PRIu32 " us",
+                 channel, s_stats.transmit_us[channel], s_stats.transmit_peak_us[channel]);
+    }
+}
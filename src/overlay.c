@@ -0,0 +1,128 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Effects stacked in the layers of a compositor
+ */
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/overlay.h"
+#include "include/arena.h"
+#include "include/matrix.h"
+#include "include/rainbow.h"
+
+static const char *TAG = "OVERLAY";
+
+#define OVERLAY_FPS    50  // Fast enough for the layers up to 50 FPS
+
+typedef struct {
+    const overlay_config_t *config;
+    compositor_t compositor;
+    void *states[OVERLAY_MAX_LAYERS];
+    uint32_t elapsed_ms[OVERLAY_MAX_LAYERS];  // Since the last step of the layer
+    bool started[OVERLAY_MAX_LAYERS];
+} overlay_state_t;
+
+
+/**
+ * @brief Carve the layers and the states of the effects from the arena
+ * The overlay stays black if the arena is too small.
+ */
+void overlay_init(void *state, const void *config) {
+    overlay_state_t *overlay = state;
+    const overlay_config_t *overlay_config = config;
+    uint8_t count = MIN_(overlay_config->count, OVERLAY_MAX_LAYERS);
+
+    layer_t *layers = arena_alloc(count * sizeof(layer_t));
+    for (uint8_t i = 0; i < count && layers; i++) {
+        const effect_t *effect = overlay_config->layers[i].effect;
+        overlay->states[i] = arena_alloc(MAX_(1, effect->state_size));
+        if (!overlay->states[i])
+            layers = NULL;
+    }
+    if (!layers) {
+        ESP_LOGE(TAG, "Arena too small for %d layers", count);
+        compositor_init(&overlay->compositor, NULL, 0);
+        return;
+    }
+
+    overlay->config = overlay_config;
+    compositor_init(&overlay->compositor, layers, count);
+    for (uint8_t i = 0; i < count; i++) {
+        const overlay_layer_t *layer = &overlay_config->layers[i];
+        compositor_set_layer(&overlay->compositor, i, layer->mode, layer->opacity);
+        fb_clear(&layers[i].fb);
+        if (layer->effect->init)
+            layer->effect->init(overlay->states[i], layer->effect->config);
+    }
+}
+
+
+/**
+ * @brief Step the layers that are due, then compose them
+ */
+void overlay_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    overlay_state_t *overlay = state;
+    compositor_t *compositor = &overlay->compositor;
+
+    for (uint8_t i = 0; i < compositor->count; i++) {
+        const effect_t *effect = overlay->config->layers[i].effect;
+        uint32_t period_ms = 1000u / effect->fps;
+
+        if (!overlay->started[i]) {
+            effect->step(overlay->states[i], 0, &compositor->layers[i].fb);
+            overlay->started[i] = true;
+            continue;
+        }
+        overlay->elapsed_ms[i] += dt_ms;
+        if (overlay->elapsed_ms[i] < period_ms)
+            continue;
+        // Whole periods only: the remainder is kept for the next step, no drift
+        uint32_t step_ms = overlay->elapsed_ms[i] - overlay->elapsed_ms[i] % period_ms;
+        effect->step(overlay->states[i], step_ms, &compositor->layers[i].fb);
+        overlay->elapsed_ms[i] -= step_ms;
+    }
+
+    compositor_render(compositor, fb);
+}
+
+
+void overlay_teardown(void *state) {
+    overlay_state_t *overlay = state;
+
+    for (uint8_t i = 0; i < overlay->compositor.count; i++) {
+        const effect_t *effect = overlay->config->layers[i].effect;
+        if (effect->teardown)
+            effect->teardown(overlay->states[i]);
+    }
+}
+
+
+// Matrix rain over a dim rainbow
+static const overlay_layer_t matrix_rainbow_layers[] = {
+    { .effect = &g_rainbow_effect, .mode = BLEND_ALPHA, .opacity = 64 },
+    { .effect = &g_matrix_effect, .mode = BLEND_ADD, .opacity = 255 },
+};
+
+const effect_t g_matrix_rainbow_effect = {
+    .name       = "matrix_rainbow",
+    .fps        = OVERLAY_FPS,
+    .state_size = sizeof(overlay_state_t),
+    .config     = &(const overlay_config_t){ .layers = matrix_rainbow_layers, .count = 2 },
+    .init       = overlay_init,
+    .step       = overlay_step,
+    .teardown   = overlay_teardown,
+};
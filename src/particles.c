@@ -0,0 +1,187 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Pooled particle system: emitters, motion and additive splatting
+ */
+// Local imports
+#include "include/particles.h"
+
+// Longest step integrated at once; keeps the products on 32 bits
+#define PARTICLE_MAX_DT_MS    250
+// Particles leaving the cube by more than this margin are killed, Q8
+#define PARTICLE_MARGIN       (2 << 8)
+
+
+/**
+ * @brief Empty the pool: chain all the slots in the free list
+ */
+void particle_pool_init(particle_pool_t *pool, int16_t gravity, bool fade) {
+    for (uint16_t i = 0; i < PARTICLE_CAPACITY; i++) {
+        pool->life[i] = 0;
+        pool->next_free[i] = i + 1;
+    }
+    pool->next_free[PARTICLE_CAPACITY - 1] = PARTICLE_NONE;
+    pool->free_head = 0;
+    pool->count = 0;
+    pool->gravity = gravity;
+    pool->fade = fade;
+}
+
+
+/**
+ * @brief Take a slot from the free list
+ * The attributes of the particle must be set by the caller.
+ * @return Index of the particle, PARTICLE_NONE if the pool is full.
+ */
+uint16_t particle_spawn(particle_pool_t *pool) {
+    uint16_t index = pool->free_head;
+    if (index == PARTICLE_NONE)
+        return PARTICLE_NONE;
+
+    pool->free_head = pool->next_free[index];
+    pool->count++;
+    return index;
+}
+
+
+void particle_kill(particle_pool_t *pool, uint16_t index) {
+    pool->life[index] = 0;
+    pool->next_free[index] = pool->free_head;
+    pool->free_head = index;
+    pool->count--;
+}
+
+
+static inline int32_t jitter(prng_t *rng, int32_t spread) {
+    return (spread > 0) ? (int32_t) prng_below(rng, 2 * spread + 1) - spread : 0;
+}
+
+
+/**
+ * @brief Spawn count particles at once (explosions)
+ * @return Number of particles spawned, less than count if the pool is full.
+ */
+uint16_t particle_burst(particle_pool_t *pool, const particle_emitter_t *emitter, prng_t *rng, uint16_t count) {
+    uint16_t spawned = 0;
+
+    for (; spawned < count; spawned++) {
+        uint16_t i = particle_spawn(pool);
+        if (i == PARTICLE_NONE)
+            break;
+
+        pool->x[i] = emitter->position[0] + jitter(rng, emitter->position_spread);
+        pool->y[i] = emitter->position[1] + jitter(rng, emitter->position_spread);
+        pool->z[i] = emitter->position[2] + jitter(rng, emitter->position_spread);
+        pool->vx[i] = emitter->velocity[0] + jitter(rng, emitter->velocity_spread);
+        pool->vy[i] = emitter->velocity[1] + jitter(rng, emitter->velocity_spread);
+        pool->vz[i] = emitter->velocity[2] + jitter(rng, emitter->velocity_spread);
+        pool->life[i] = MAX_(1, emitter->life_ms + jitter(rng, emitter->life_spread_ms));
+        pool->ttl[i] = pool->life[i];
+        pool->color[i] = emitter->color;
+    }
+    return spawned;
+}
+
+
+/**
+ * @brief Spawn the particles due for dt_ms at the rate of the emitter
+ * @return Number of particles spawned.
+ */
+uint16_t particle_emit(particle_pool_t *pool, particle_emitter_t *emitter, prng_t *rng, uint32_t dt_ms) {
+    emitter->pending += MIN_(dt_ms, PARTICLE_MAX_DT_MS) * emitter->rate;
+    uint16_t due = emitter->pending / 1000;
+    emitter->pending -= due * 1000;
+    return particle_burst(pool, emitter, rng, due);
+}
+
+
+/**
+ * @brief Move the particles, age them, and kill the expired ones or
+ * those that left the cube
+ */
+void particle_update(particle_pool_t *pool, uint32_t dt_ms) {
+    dt_ms = MIN_(dt_ms, PARTICLE_MAX_DT_MS);
+    // Seconds elapsed, Q16
+    int32_t dt = (dt_ms << 16) / 1000;
+    int32_t dv = (pool->gravity * dt + 0x8000) >> 16;
+    const int32_t low = -PARTICLE_MARGIN;
+    const int32_t high = ((SIDE_LENGTH - 1) << 8) + PARTICLE_MARGIN;
+
+    for (uint16_t i = 0; i < PARTICLE_CAPACITY; i++) {
+        if (pool->life[i] == 0)
+            continue;
+
+        int32_t vz = pool->vz[i] + dv;
+        vz = MIN_(MAX_(vz, INT16_MIN), INT16_MAX);
+        int32_t x = pool->x[i] + ((pool->vx[i] * dt + 0x8000) >> 16);
+        int32_t y = pool->y[i] + ((pool->vy[i] * dt + 0x8000) >> 16);
+        int32_t z = pool->z[i] + ((vz * dt + 0x8000) >> 16);
+
+        if (pool->life[i] <= dt_ms || x < low || x > high || y < low || y > high || z < low || z > high) {
+            particle_kill(pool, i);
+            continue;
+        }
+        pool->x[i] = x;
+        pool->y[i] = y;
+        pool->z[i] = z;
+        pool->vz[i] = vz;
+        pool->life[i] -= dt_ms;
+    }
+}
+
+
+/**
+ * @brief Add the light of each particle to the 8 voxels around it
+ * Trilinear weights: the particles glide between the voxels.
+ * The channels saturate at 255.
+ */
+void particle_splat(const particle_pool_t *pool, framebuffer_t *fb) {
+    for (uint16_t i = 0; i < PARTICLE_CAPACITY; i++) {
+        if (pool->life[i] == 0)
+            continue;
+
+        // Brightness, Q8
+        uint32_t level = pool->fade ? ((uint32_t) pool->life[i] << 8) / pool->ttl[i] : 256;
+        int32_t px = pool->x[i], py = pool->y[i], pz = pool->z[i];
+        // Lower corner and fraction towards the upper one, Q8
+        int8_t x0 = px >> 8, y0 = py >> 8, z0 = pz >> 8;
+        uint32_t fx = px & 0xFF, fy = py & 0xFF, fz = pz & 0xFF;
+        color_t color = pool->color[i];
+
+        for (uint8_t corner = 0; corner < 8; corner++) {
+            int8_t x = x0 + (corner & 1);
+            int8_t y = y0 + ((corner >> 1) & 1);
+            int8_t z = z0 + (corner >> 2);
+            if (x < 0 || x >= SIDE_LENGTH || y < 0 || y >= SIDE_LENGTH || z < 0 || z >= SIDE_LENGTH)
+                continue;
+
+            uint32_t wx = (corner & 1) ? fx : 256 - fx;
+            uint32_t wy = (corner & 2) ? fy : 256 - fy;
+            uint32_t wz = (corner & 4) ? fz : 256 - fz;
+            // Weight of the corner scaled by the brightness, Q8
+            uint32_t weight = (((wx * wy) >> 8) * wz * level) >> 16;
+            if (weight == 0)
+                continue;
+
+            color_t *pixel = &fb->pixels[x][y][z];
+            color_t sum = {
+                .red = MIN_(255, pixel->red + ((color.red * weight) >> 8)),
+                .green = MIN_(255, pixel->green + ((color.green * weight) >> 8)),
+                .blue = MIN_(255, pixel->blue + ((color.blue * weight) >> 8)),
+            };
+            fb_write(fb, pixel, sum);
+        }
+    }
+}
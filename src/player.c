@@ -0,0 +1,114 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Playback of the compressed animation stored in the "anims" partition
+ */
+// Espressif imports
+#include <esp_log.h>
+#include <esp_partition.h>
+
+// Local imports
+#include "include/player.h"
+#include "include/stream.h"
+
+static const char *TAG = "PLAYER";
+
+#define PLAYER_FPS    50  // Frames of the stream are decoded when due at this rate
+
+typedef struct {
+    stream_t stream;
+    esp_partition_mmap_handle_t mmap_handle;
+    bool mapped;
+    bool playing;
+    uint32_t time_ms;
+    uint32_t decoded;   // Frames decoded since the start of the effect
+} player_state_t;
+
+
+/**
+ * @brief Map the partition and open its stream
+ */
+void player_init(void *state, const void *config) {
+    (void) config;
+    player_state_t *player = state;
+
+    const esp_partition_t *partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t) STREAM_PARTITION_SUBTYPE,
+        STREAM_PARTITION_LABEL);
+    if (!partition) {
+        ESP_LOGW(TAG, "No %s partition", STREAM_PARTITION_LABEL);
+        return;
+    }
+
+    const void *data;
+    esp_err_t ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &data, &player->mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Can't map the partition: %s", esp_err_to_name(ret));
+        return;
+    }
+    player->mapped = true;
+
+    ret = stream_open(&player->stream, data, partition->size);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "No valid stream in the partition: %s", esp_err_to_name(ret));
+        return;
+    }
+    ESP_LOGI(TAG, "%" PRIu32 " frames at %d fps", player->stream.frame_count, player->stream.fps);
+    player->playing = true;
+}
+
+
+/**
+ * @brief Decode the frames due since the previous step
+ * Deltas depend on the previous frame: late frames are decoded, not skipped.
+ */
+void player_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    player_state_t *player = state;
+
+    if (!player->playing)
+        return;
+
+    player->time_ms += dt_ms;
+    uint32_t due = (uint64_t) player->time_ms * player->stream.fps / 1000 + 1;
+
+    for (; player->decoded < due; player->decoded++) {
+        esp_err_t ret = stream_decode_next(&player->stream, fb);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Corrupted frame %" PRIu32 ": %s",
+                     player->stream.frame, esp_err_to_name(ret));
+            player->playing = false;
+            return;
+        }
+    }
+}
+
+
+void player_teardown(void *state) {
+    player_state_t *player = state;
+
+    if (player->mapped)
+        esp_partition_munmap(player->mmap_handle);
+}
+
+
+const effect_t g_player_effect = {
+    .name       = "player",
+    .fps        = PLAYER_FPS,
+    .state_size = sizeof(player_state_t),
+    .init       = player_init,
+    .step       = player_step,
+    .teardown   = player_teardown,
+};
@@ -0,0 +1,71 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Seedable pseudo random number generator
+ */
+// Standard imports
+#include <string.h>  // memcpy
+
+// Espressif imports
+#include <esp_random.h>
+
+// Local imports
+#include "include/prng.h"
+
+// Pin it to get the same frames on every run
+uint32_t g_prng_seed = PRNG_SEED;
+
+
+/**
+ * @brief Initialize the state from a 32-bit seed
+ * The seed is expanded with splitmix32 so that close seeds give
+ * unrelated sequences and the state is never all zeros.
+ */
+void prng_seed(prng_t *rng, uint32_t seed) {
+    for (uint8_t i = 0; i < 4; i++) {
+        uint32_t z = (seed += 0x9E3779B9);
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        rng->state[i] = z ^ (z >> 16);
+    }
+}
+
+
+/**
+ * @brief Seed the generator from g_prng_seed, or from the hardware RNG
+ */
+void prng_init(prng_t *rng) {
+    prng_seed(rng, (g_prng_seed != PRNG_RANDOM_SEED) ? g_prng_seed : esp_random());
+}
+
+
+/**
+ * @brief Fill the buffer with random bytes, 4 bytes per draw
+ */
+void prng_fill(prng_t *rng, void *buffer, size_t size) {
+    uint8_t *bytes = buffer;
+
+    while (size >= sizeof(uint32_t)) {
+        uint32_t value = prng_next(rng);
+        memcpy(bytes, &value, sizeof(value));
+        bytes += sizeof(value);
+        size -= sizeof(value);
+    }
+
+    if (size) {
+        uint32_t value = prng_next(rng);
+        memcpy(bytes, &value, size);
+    }
+}
@@ -24,6 +24,15 @@
 
 static const char *TAG = "RAINBOW";
 
+#define RAINBOW_FPS          10    // One frame per LED
+#define RAINBOW_LED_DELAY    100   // One more LED every 100ms
+#define RAINBOW_HOLD_DELAY   2000  // Time the full cube stays on before a restart
+
+typedef struct {
+    uint32_t time_ms;  // Since the start of the animation
+    uint16_t lit;      // Number of LEDs on
+} rainbow_state_t;
+
 /**
  * @brief Generate rainbow colors across 0-255 positions
  */
@@ -53,35 +62,38 @@ color_t wheel(uint8_t pos) {
 
 
 /**
- * @brief Entry point for a rainbow animation accros the planes
+ * @brief Rainbow animation accros the planes
+ * LEDs are lit one by one, bottom plane first.
  */
-void rainbow(led_strip_handle_t *led_strip) {
-    uint8_t pos = 0;
-
-    ESP_LOGI(TAG, "Animation: rainbow");
+void rainbow_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    rainbow_state_t *rainbow = state;
 
-#ifndef PIO_QEMU_ENV
-    ESP_ERROR_CHECK(led_strip_clear(*led_strip));
-#endif
+    rainbow->time_ms += dt_ms;
+    if (rainbow->time_ms >= RAINBOW_LED_DELAY * (uint32_t) g_side3 + RAINBOW_HOLD_DELAY) {
+        // Start over
+        fb_clear(fb);
+        rainbow->time_ms = 0;
+        rainbow->lit = 0;
+    }
 
-    // Bottom plane first
-    for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
-        for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
-            for (uint8_t x = 0; x < SIDE_LENGTH; x++) {
-                color_t color = wheel(pos * 256 / g_side3);
-#ifndef PIO_QEMU_ENV
-                led_strip_set_pixel(*led_strip, get_pix_id(x, y, z), color.red, color.green, color.blue);
-                ESP_ERROR_CHECK(led_strip_refresh(*led_strip));
-#endif
-                ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d", get_pix_id(x, y, z), color.red, color.green, color.blue);
-                pos++;
+    uint16_t target = MIN_(g_side3, rainbow->time_ms / RAINBOW_LED_DELAY + 1);
+    for (; rainbow->lit < target; rainbow->lit++) {
+        pix_id_t pos = rainbow->lit;
+        uint8_t x = pos % SIDE_LENGTH;
+        uint8_t y = (pos / SIDE_LENGTH) % SIDE_LENGTH;
+        uint8_t z = pos / g_side2;
 
-                if (g_button_pressed)
-                    return;
+        color_t color = wheel((uint32_t) pos * 256 / g_side3);
+        fb_set_pixel(fb, x, y, z, color);
 
-                vTaskDelay(pdMS_TO_TICKS(100));
-            }
-        }
+        ESP_LOGD(TAG, "px: (%d, %d, %d), red: %d, green: %d, blue: %d", x, y, z, color.red, color.green, color.blue);
     }
-    vTaskDelay(pdMS_TO_TICKS(2000));
 }
+
+
+const effect_t g_rainbow_effect = {
+    .name       = "rainbow",
+    .fps        = RAINBOW_FPS,
+    .state_size = sizeof(rainbow_state_t),
+    .step       = rainbow_step,
+};
@@ -15,17 +15,109 @@
 /**
  * @brief Random animation
  */
+// Standard imports
+#include <string.h>  // memset
+
 // Espressif imports
 #include <esp_log.h>
 
 // Local imports
 #include "include/random.h"
 #include "include/commons.h"
+#include "include/mapping.h"
+#include "include/prng.h"
 
 static const char *TAG = "RANDOM";
 
+#define RANDOM_FPS          50     // Draws are grouped at this frame rate
+#define RANDOM_DRAWS        16000  // Number of draws of the animation
+#define MAX_DRAW_DELAY      50     // Max random delay between 2 draws (ms)
+#define RANDOM_HOLD_DELAY   2000   // Pause after the last draw, before a restart
+
+typedef struct {
+    prng_t rng;
+    // Number of draws for each LED
+    uint8_t shots[LED_STRIP_LED_COUNT];
+    // Color of each LED, kept for the next draws
+    color_t colors[LED_STRIP_LED_COUNT];
+    uint16_t draws;
+    // Times in ms since the start of the animation
+    uint32_t time_ms;
+    uint32_t next_draw_ms;
+} random_state_t;
+
+
+/**
+ * @brief Draw one random LED and make it progress in its fade in/out cycle
+ */
+void random_draw(random_state_t *anim, framebuffer_t *fb) {
+    // Choose coordinates: [0;SIDE_LENGTH[
+    uint8_t x = prng_below(&anim->rng, SIDE_LENGTH);
+    uint8_t y = prng_below(&anim->rng, SIDE_LENGTH);
+    uint8_t z = prng_below(&anim->rng, SIDE_LENGTH);
+
+    pix_id_t pos = get_pix_id(x, y, z);
+    uint8_t shot = anim->shots[pos];
+
+    // Working cell color
+    color_t *color = &anim->colors[pos];
+
+    ESP_LOGD(TAG, "px id: %d; shots: %d", pos, shot);
+
+    // Shot == 0: initialize the channels
+    // Shot <= 5: increase the brightness
+    // Shot <= 10: decrease the brightness
+    // Shot == 11: reset the channels
+    if (shot == 0) {
+        // Set color
+        // 16 max divided by 2: 8max (try to eliminate small values)
+        // Then followed by 5 multiplications by 2 : 255 max (keep color channels ratio)
+        // 15: (15>>1)*2**5 = 224 max
+        color->red   = prng_below(&anim->rng, 17) >> 1; // 256 max
+        color->green = prng_below(&anim->rng, 17) >> 1; // 256 max
+        color->blue  = prng_below(&anim->rng, 14) >> 1; // 14: 192 max, 11: 160 max
+    } else if (shot <= 5) {
+        // Increase brightness
+        ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d [BEFORE]", pos, color->red, color->green, color->blue);
+
+        color->red = MIN_(224, color->red << 1);
+        color->green = MIN_(224, color->green << 1);
+        color->blue = MIN_(224, color->blue << 1);
+    } else if (shot <= 10) {
+        // Decrease brightness
+        ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d [BEFORE]", pos, color->red, color->green, color->blue);
+
+        color->red >>= 1;
+        color->green >>= 1;
+        color->blue >>= 1;
+    } else {
+        // Shutdown
+        color->red = 0;
+        color->green = 0;
+        color->blue = 0;
+    }
+
+    if (shot == 11) {
+        anim->shots[pos] = 0;
+    } else {
+        anim->shots[pos]++;
+    }
+
+    fb_set_pixel(fb, x, y, z, *color);
+    ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d", pos, color->red, color->green, color->blue);
+}
+
+
+void random_init(void *state, const void *config) {
+    (void) config;
+    random_state_t *anim = state;
+
+    prng_init(&anim->rng);
+}
+
+
 /**
- * @brief Entry point for the randomisation animation
+ * @brief Step of the randomisation animation
  * Fade in / out LEDs, with random positions & colors.
  *
  * - Choose random coordinates (x, y, z)
@@ -39,99 +131,45 @@ static const char *TAG = "RANDOM";
  * multiplied/divided by 2. Thus the initial value of a channel
  * should accept a multiplication by 2**5 (32) and still not overflow
  * the uint8_t max value (255).
+ *
+ * Draws are separated by random delays; all the draws falling in the same
+ * frame are sent to the strip at once.
  */
-void randomisation(led_strip_handle_t *led_strip) {
-    ESP_LOGI(TAG, "Animation: randomisation");
-
-    // Init seed
-    srand(esp_random());
-
-#ifndef PIO_QEMU_ENV
-    ESP_ERROR_CHECK(led_strip_clear(*led_strip));
-#endif
-
-    // Keep the number of draws for each LED
-    uint8_t *shots = calloc(LED_STRIP_LED_COUNT, sizeof(int));
-    if (!shots)
-        return;
-
-    color_t *colors = calloc(LED_STRIP_LED_COUNT, sizeof(color_t));
-    if (!colors) {
-        free(shots);
-        return;
+void random_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    random_state_t *anim = state;
+
+    anim->time_ms += dt_ms;
+
+    if (anim->draws == RANDOM_DRAWS) {
+        if (anim->time_ms < anim->next_draw_ms + RANDOM_HOLD_DELAY)
+            return;
+
+        // Start over
+        fb_clear(fb);
+        memset(anim->shots, 0, sizeof(anim->shots));
+        memset(anim->colors, 0, sizeof(anim->colors));
+        anim->draws = 0;
+        anim->time_ms = 0;
+        anim->next_draw_ms = 0;
     }
 
-    for (uint16_t draw = 0; draw < 16000; draw++) {
-        // Choose coordinates: [0;4[
-        uint8_t x = rand() % SIDE_LENGTH;
-        uint8_t y = rand() % SIDE_LENGTH;
-        uint8_t z = rand() % SIDE_LENGTH;
-
-        uint8_t pos = get_pix_id(x, y, z);
-        uint8_t shot = shots[pos];
-
-        // Working cell color
-        color_t *color = &colors[pos];
-
-        ESP_LOGD(TAG, "px id: %d; shots: %d", pos, shot);
-
-        // Shot == 0: initialize the channels
-        // Shot <= 5: increase the brightness
-        // Shot <= 10: decrease the brightness
-        // Shot == 11: reset the channels
-        if (shot == 0) {
-            // Set color
-            // 16 max divided by 2: 8max (try to eliminate small values)
-            // Then followed by 5 multiplications by 2 : 255 max (keep color channels ratio)
-            // 15: (15>>1)*2**5 = 224 max
-            color->red   = (rand() % 17) >> 1; // 256 max
-            color->green = (rand() % 17) >> 1; // 256 max
-            color->blue  = (rand() % 14) >> 1; // 14: 192 max, 11: 160 max
-        } else if (shot <= 5) {
-            // Increase brightness
-            ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d [BEFORE]", pos, color->red, color->green, color->blue);
-
-            color->red = MIN_(224, color->red << 1);
-            color->green = MIN_(224, color->green << 1);
-            color->blue = MIN_(224, color->blue << 1);
-        } else if (shot <= 10) {
-            // Decrease brightness
-            ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d [BEFORE]", pos, color->red, color->green, color->blue);
-
-            color->red >>= 1;
-            color->green >>= 1;
-            color->blue >>= 1;
-        } else {
-            // Shutdown
-            color->red = 0;
-            color->green = 0;
-            color->blue = 0;
-        }
-
-        if (shot == 11) {
-            shots[pos] = 0;
-        } else {
-            shots[pos]++;
-        }
-
-#ifndef PIO_QEMU_ENV
-        led_strip_set_pixel(*led_strip, pos, color->red, color->green, color->blue);
-        ESP_ERROR_CHECK(led_strip_refresh(*led_strip));
-#endif
-        ESP_LOGD(TAG, "px id: %d, red: %d, green: %d, blue: %d", pos, color->red, color->green, color->blue);
-
-        if (g_button_pressed)
-            goto end;
+    // Do all the draws that are due
+    while (anim->draws < RANDOM_DRAWS && anim->next_draw_ms <= anim->time_ms) {
+        random_draw(anim, fb);
+        anim->draws++;
 
         // Random delay between 2 draws
-        uint16_t delay = rand() % 51;
+        uint16_t delay = prng_below(&anim->rng, MAX_DRAW_DELAY + 1);
         ESP_LOGD(TAG, "Wait: %dms", delay);
-        vTaskDelay(pdMS_TO_TICKS(delay));
+        anim->next_draw_ms += delay;
     }
+}
 
-    vTaskDelay(pdMS_TO_TICKS(2000));
 
-end:
-    free(shots);
-    free(colors);
-}
+const effect_t g_random_effect = {
+    .name       = "randomisation",
+    .fps        = RANDOM_FPS,
+    .state_size = sizeof(random_state_t),
+    .init       = random_init,
+    .step       = random_step,
+};
@@ -0,0 +1,52 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief List of the scenarios, in the order of the button presses
+ */
+// Local imports
+#include "include/registry.h"
+#include "include/base.h"
+#include "include/rainbow.h"
+#include "include/random.h"
+#include "include/fire.h"
+#include "include/matrix.h"
+#include "include/shapes.h"
+#include "include/fireworks.h"
+#include "include/overlay.h"
+#include "include/player.h"
+#include "include/live.h"
+#include "include/tether.h"
+
+const effect_t *const g_effects[] = {
+    &g_base_effect,
+    &g_rainbow_effect,
+    &g_random_effect,
+    &g_red_fire_effect,
+    &g_green_fire_effect,
+    &g_matrix_effect,
+    &g_matrix_side_effect,
+    &g_shapes_effect,
+    &g_fireworks_effect,
+    &g_matrix_rainbow_effect,
+    &g_player_effect,
+#ifdef WIFI_SSID
+    &g_live_effect,
+#endif
+#ifdef SERIAL_STREAMING
+    &g_tether_effect,
+#endif
+};
+
+const uint8_t g_effect_count = sizeof(g_effects) / sizeof(g_effects[0]);
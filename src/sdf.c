@@ -0,0 +1,359 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Fixed-point rasterizer of signed distance functions
+ *
+ * The field is filled one shape at a time, one row of voxels along Z at
+ * a time: the local coordinates are affine in z, each row is a fixed
+ * length loop of 32-bit additions, multiplications and min/max without
+ * branches, that the compiler can unroll and vectorise.
+ */
+// Standard imports
+#include <stdlib.h>  // abs
+#include <string.h>
+
+// Local imports
+#include "include/sdf.h"
+
+#define CLAMP_(v, lo, hi)    MIN_(MAX_((v), (lo)), (hi))
+
+// sin(i * pi/128), i in [0;64], Q14
+static const int16_t sin_quarter[65] = {
+    0, 402, 804, 1205, 1606, 2006, 2404, 2801, 3196, 3590, 3981, 4370, 4756,
+    5139, 5520, 5897, 6270, 6639, 7005, 7366, 7723, 8076, 8423, 8765, 9102,
+    9434, 9760, 10080, 10394, 10702, 11003, 11297, 11585, 11866, 12140, 12406,
+    12665, 12916, 13160, 13395, 13623, 13842, 14053, 14256, 14449, 14635,
+    14811, 14978, 15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+    16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379, 16384,
+};
+
+
+/**
+ * @brief Sine of a binary angle (256: full turn), Q14
+ */
+int16_t sdf_sin(uint8_t angle) {
+    uint8_t index = angle & 63;
+    int16_t value = (angle & 64) ? sin_quarter[64 - index] : sin_quarter[index];
+    return (angle & 128) ? -value : value;
+}
+
+
+int16_t sdf_cos(uint8_t angle) {
+    return sdf_sin(angle + 64);
+}
+
+
+uint32_t sdf_isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+
+/**
+ * @brief Scale the given vector to a length of SDF_UNIT
+ * The components must be below 2^17 (in absolute value).
+ */
+static void normalize(int32_t v[3]) {
+    // Bring the squares below 2^30
+    int32_t shift = 0;
+    while (MAX_(MAX_(abs(v[0]), abs(v[1])), abs(v[2])) >> shift >= (1 << 14))
+        shift++;
+
+    int32_t a = v[0] >> shift, b = v[1] >> shift, c = v[2] >> shift;
+    int32_t length = sdf_isqrt((uint32_t) (a * a + b * b + c * c));
+    if (length == 0)
+        return;
+
+    v[0] = a * SDF_UNIT / length;
+    v[1] = b * SDF_UNIT / length;
+    v[2] = c * SDF_UNIT / length;
+}
+
+
+/**
+ * @brief Cross product of two Q14 vectors, Q14
+ */
+static void cross(const int32_t a[3], const int32_t b[3], int32_t out[3]) {
+    out[0] = (a[1] * b[2] - a[2] * b[1]) >> 14;
+    out[1] = (a[2] * b[0] - a[0] * b[2]) >> 14;
+    out[2] = (a[0] * b[1] - a[1] * b[0]) >> 14;
+}
+
+
+/**
+ * @brief No rotation, centered on the given point
+ */
+void sdf_identity(sdf_transform_t *transform, const int32_t origin[3]) {
+    memset(transform->m, 0, sizeof(transform->m));
+    for (uint8_t i = 0; i < 3; i++) {
+        transform->m[i][i] = SDF_UNIT;
+        transform->origin[i] = origin[i];
+    }
+}
+
+
+/**
+ * @brief Rotate the shape around its origin
+ * Rotations around the X axis (roll), then Y (pitch), then Z (yaw);
+ * binary angles, 256: full turn. The origin is kept.
+ */
+void sdf_orient(sdf_transform_t *transform, uint8_t yaw, uint8_t pitch, uint8_t roll) {
+    int32_t cy = sdf_cos(yaw), sy = sdf_sin(yaw);
+    int32_t cp = sdf_cos(pitch), sp = sdf_sin(pitch);
+    int32_t cr = sdf_cos(roll), sr = sdf_sin(roll);
+    int32_t spsr = (sp * sr) >> 14;
+    int32_t spcr = (sp * cr) >> 14;
+
+    // Rows of the world to local matrix: transpose of Rz * Ry * Rx
+    int32_t (*m)[3] = transform->m;
+    m[0][0] = (cy * cp) >> 14;
+    m[0][1] = (sy * cp) >> 14;
+    m[0][2] = -sp;
+    m[1][0] = ((cy * spsr) >> 14) - ((sy * cr) >> 14);
+    m[1][1] = ((sy * spsr) >> 14) + ((cy * cr) >> 14);
+    m[1][2] = (cp * sr) >> 14;
+    m[2][0] = ((cy * spcr) >> 14) + ((sy * sr) >> 14);
+    m[2][1] = ((sy * spcr) >> 14) - ((cy * sr) >> 14);
+    m[2][2] = (cp * cr) >> 14;
+}
+
+
+/**
+ * @brief Rotate the shape so that its local Z axis follows the given direction
+ * Any scale, Q8 coordinates for example. The origin is kept.
+ */
+void sdf_align(sdf_transform_t *transform, const int32_t direction[3]) {
+    int32_t n[3] = { direction[0], direction[1], direction[2] };
+    normalize(n);
+
+    // Build the X axis from the world axis the least aligned with the direction
+    int32_t helper[3] = { 0, 0, 0 };
+    uint8_t axis = 0;
+    for (uint8_t i = 1; i < 3; i++) {
+        if (abs(n[i]) < abs(n[axis]))
+            axis = i;
+    }
+    helper[axis] = SDF_UNIT;
+
+    int32_t u[3], v[3];
+    cross(helper, n, u);
+    normalize(u);
+    cross(n, u, v);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        transform->m[0][i] = u[i];
+        transform->m[1][i] = v[i];
+        transform->m[2][i] = n[i];
+    }
+}
+
+
+void sdf_sphere(sdf_shape_t *shape, sdf_op_t op, const int32_t center[3], int32_t radius) {
+    shape->type = SDF_SPHERE;
+    shape->op = op;
+    sdf_identity(&shape->transform, center);
+    shape->size[0] = MAX_(radius, 1);
+    shape->size[1] = shape->size[2] = 0;
+}
+
+
+/**
+ * @brief Axis aligned box; rotate it with sdf_orient()
+ */
+void sdf_box(sdf_shape_t *shape, sdf_op_t op, const int32_t center[3], const int32_t half[3]) {
+    shape->type = SDF_BOX;
+    shape->op = op;
+    sdf_identity(&shape->transform, center);
+    memcpy(shape->size, half, sizeof(shape->size));
+}
+
+
+/**
+ * @brief Half-space behind the plane going through point; the normal points outside
+ */
+void sdf_plane(sdf_shape_t *shape, sdf_op_t op, const int32_t point[3], const int32_t normal[3]) {
+    shape->type = SDF_PLANE;
+    shape->op = op;
+    sdf_identity(&shape->transform, point);
+    sdf_align(&shape->transform, normal);
+    memset(shape->size, 0, sizeof(shape->size));
+}
+
+
+/**
+ * @brief Segment with rounded ends (capsule) between two points
+ */
+void sdf_line(sdf_shape_t *shape, sdf_op_t op, const int32_t from[3], const int32_t to[3], int32_t radius) {
+    int32_t direction[3] = { to[0] - from[0], to[1] - from[1], to[2] - from[2] };
+
+    shape->type = SDF_CAPSULE;
+    shape->op = op;
+    sdf_identity(&shape->transform, from);
+    shape->size[0] = MAX_(radius, 1);
+    shape->size[1] = sdf_isqrt((uint32_t) (direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]));
+    shape->size[2] = 0;
+    if (shape->size[1] > 0)
+        sdf_align(&shape->transform, direction);
+}
+
+
+/**
+ * @brief Distances of a shape along the row (x, y, 0..SIDE_LENGTH-1)
+ * The local coordinates are base + z * step, Q22 before the >> 14.
+ * Round shapes: d ~ (|p|² - r²) / 2r, exact on the surface and of the
+ * right sign everywhere; boxes: Chebyshev distance to the faces.
+ */
+static void eval_row(const sdf_shape_t *shape, uint8_t x, uint8_t y, int16_t dist[SIDE_LENGTH]) {
+    const sdf_transform_t *t = &shape->transform;
+    int32_t dx = (x << 8) - t->origin[0];
+    int32_t dy = (y << 8) - t->origin[1];
+    int32_t base[3], step[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        base[i] = t->m[i][0] * dx + t->m[i][1] * dy - t->m[i][2] * t->origin[2];
+        step[i] = t->m[i][2] << 8;
+    }
+
+    switch (shape->type) {
+    case SDF_SPHERE:
+    case SDF_CAPSULE: {
+        int32_t radius = shape->size[0];
+        int32_t length = (shape->type == SDF_CAPSULE) ? shape->size[1] : 0;
+        int32_t r2 = radius * radius;
+        int32_t limit = 2 * radius * SDF_DIST_MAX;
+        // 2^24 / 2r: the products stay below 2^27
+        int32_t inverse = (1 << 24) / (2 * radius);
+
+        for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+            int32_t lx = (base[0] + z * step[0]) >> 14;
+            int32_t ly = (base[1] + z * step[1]) >> 14;
+            int32_t lz = (base[2] + z * step[2]) >> 14;
+            // Capsule: distance to the closest point of the segment
+            lz -= CLAMP_(lz, 0, length);
+            int32_t e = lx * lx + ly * ly + lz * lz - r2;
+            e = CLAMP_(e, -limit, limit);
+            dist[z] = (int16_t) (((e >> 8) * inverse) >> 16);
+        }
+        break;
+    }
+    case SDF_BOX: {
+        int32_t hx = shape->size[0], hy = shape->size[1], hz = shape->size[2];
+
+        for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+            int32_t lx = (base[0] + z * step[0]) >> 14;
+            int32_t ly = (base[1] + z * step[1]) >> 14;
+            int32_t lz = (base[2] + z * step[2]) >> 14;
+            int32_t d = MAX_(MAX_(abs(lx) - hx, abs(ly) - hy), abs(lz) - hz);
+            dist[z] = (int16_t) CLAMP_(d, -SDF_DIST_MAX, SDF_DIST_MAX);
+        }
+        break;
+    }
+    case SDF_PLANE:
+    default:
+        for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+            int32_t lz = (base[2] + z * step[2]) >> 14;
+            dist[z] = (int16_t) CLAMP_(lz, -SDF_DIST_MAX, SDF_DIST_MAX);
+        }
+        break;
+    }
+}
+
+
+/**
+ * @brief Evaluate the list of shapes over the whole volume
+ * The shapes are combined in order, each one with the result of the
+ * previous ones (the field starts empty: begin with an SDF_UNION).
+ */
+void sdf_render(sdf_field_t *field, const sdf_shape_t *shapes, size_t count) {
+    int16_t *all = &field->d[0][0][0];
+    for (uint16_t i = 0; i < LED_STRIP_LED_COUNT; i++)
+        all[i] = SDF_DIST_MAX;
+
+    for (size_t s = 0; s < count; s++) {
+        const sdf_shape_t *shape = &shapes[s];
+
+        for (uint8_t x = 0; x < SIDE_LENGTH; x++) {
+            for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
+                int16_t dist[SIDE_LENGTH];
+                int16_t *row = field->d[x][y];
+                eval_row(shape, x, y, dist);
+
+                switch (shape->op) {
+                case SDF_UNION:
+                    for (uint8_t z = 0; z < SIDE_LENGTH; z++)
+                        row[z] = MIN_(row[z], dist[z]);
+                    break;
+                case SDF_INTERSECT:
+                    for (uint8_t z = 0; z < SIDE_LENGTH; z++)
+                        row[z] = MAX_(row[z], dist[z]);
+                    break;
+                case SDF_SUBTRACT:
+                    for (uint8_t z = 0; z < SIDE_LENGTH; z++)
+                        row[z] = MAX_(row[z], -dist[z]);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Draw the inside of the field with the given color
+ * Anti-aliasing: the coverage of a voxel goes linearly from 0 to 1 while
+ * the surface crosses it (d from +0.5 to -0.5 voxel).
+ */
+void sdf_shade(const sdf_field_t *field, color_t color, sdf_blend_t blend, framebuffer_t *fb) {
+    for (uint8_t x = 0; x < SIDE_LENGTH; x++) {
+        for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
+            const int16_t *row = field->d[x][y];
+            uint16_t coverage[SIDE_LENGTH];
+
+            for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+                int32_t c = SDF_ONE / 2 - row[z];
+                coverage[z] = (uint16_t) CLAMP_(c, 0, SDF_ONE);
+            }
+
+            for (uint8_t z = 0; z < SIDE_LENGTH; z++) {
+                color_t *pixel = &fb->pixels[x][y][z];
+                color_t shaded = {
+                    .red = (color.red * coverage[z]) >> 8,
+                    .green = (color.green * coverage[z]) >> 8,
+                    .blue = (color.blue * coverage[z]) >> 8,
+                };
+                if (blend == SDF_BLEND_MAX) {
+                    shaded.red = MAX_(shaded.red, pixel->red);
+                    shaded.green = MAX_(shaded.green, pixel->green);
+                    shaded.blue = MAX_(shaded.blue, pixel->blue);
+                }
+                fb_write(fb, pixel, shaded);
+            }
+        }
+    }
+}
@@ -0,0 +1,210 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Reception of pixel streams over a serial link (see serial_proto.h)
+ *
+ * The driver receives the bytes by interrupt into its ring buffer; the
+ * receive task parses them into one of two payload buffers while the
+ * other one holds the last complete frame, waiting to be shown.
+ * A frame is only decoded into the framebuffer by serial_link_show(), so
+ * a new frame can be received while the previous one is shown.
+ */
+// FreeRTOS imports
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+// Espressif imports
+#include <esp_log.h>
+#ifdef SERIAL_UART_NUM
+#include <driver/uart.h>
+#else
+#include <driver/usb_serial_jtag.h>
+#endif
+
+// Local imports
+#include "include/serial_link.h"
+
+static const char *TAG = "SERIAL";
+
+static uint8_t s_payloads[2][SERIAL_MAX_PAYLOAD];
+// Buffer filled by the parser
+static uint8_t s_filled = 0;
+// Frame waiting in the other buffer
+static bool s_ready = false;
+static uint8_t s_ready_type;
+static uint16_t s_ready_length;
+// Held while the ready buffer is read or swapped
+static SemaphoreHandle_t s_lock;
+
+static serial_stats_t s_stats;
+static uint8_t s_reply[SERIAL_MAX_FRAME];
+
+
+static int link_read(uint8_t *data, uint32_t size, TickType_t timeout) {
+#ifdef SERIAL_UART_NUM
+    return uart_read_bytes(SERIAL_UART_NUM, data, size, timeout);
+#else
+    return usb_serial_jtag_read_bytes(data, size, timeout);
+#endif
+}
+
+
+static void link_write(const uint8_t *data, size_t size) {
+#ifdef SERIAL_UART_NUM
+    uart_write_bytes(SERIAL_UART_NUM, data, size);
+#else
+    usb_serial_jtag_write_bytes(data, size, portMAX_DELAY);
+#endif
+}
+
+
+/**
+ * @brief Answer the self-test frames, make the pixel frames ready to be shown
+ */
+void handle_frame(serial_parser_t *parser) {
+    size_t size;
+
+    switch (parser->type) {
+        case SERIAL_TYPE_PIXELS:
+        case SERIAL_TYPE_PIXELS_RLE:
+            s_stats.frames++;
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            if (s_ready)
+                s_stats.overruns++;
+            s_ready = true;
+            s_ready_type = parser->type;
+            s_ready_length = parser->length;
+            // The previous ready frame is dropped: fill its buffer
+            s_filled ^= 1;
+            parser->payload = s_payloads[s_filled];
+            xSemaphoreGive(s_lock);
+            break;
+
+        case SERIAL_TYPE_ECHO:
+            size = serial_encode_frame(s_reply, SERIAL_TYPE_ECHO, parser->sequence,
+                                       parser->payload, parser->length);
+            link_write(s_reply, size);
+            break;
+
+        case SERIAL_TYPE_STATS: {
+            const uint32_t counters[] = {
+                s_stats.frames, s_stats.shown, s_stats.overruns,
+                s_stats.crc_errors, s_stats.invalid, s_stats.bytes,
+            };
+            uint8_t payload[sizeof(counters)];
+
+            for (uint8_t i = 0; i < sizeof(counters) / 4; i++) {
+                for (uint8_t b = 0; b < 4; b++)
+                    payload[4 * i + b] = counters[i] >> (8 * b);
+            }
+            size = serial_encode_frame(s_reply, SERIAL_TYPE_STATS, parser->sequence,
+                                       payload, sizeof(payload));
+            link_write(s_reply, size);
+            break;
+        }
+
+        default:
+            s_stats.invalid++;
+            break;
+    }
+}
+
+
+/**
+ * @brief Receive task: parse the bytes received by the driver
+ */
+static void serial_task(void *arg) {
+    (void) arg;
+    serial_parser_t parser;
+    uint8_t chunk[128];
+
+    serial_parser_init(&parser, s_payloads[s_filled]);
+    while (1) {
+        int size = link_read(chunk, sizeof(chunk), pdMS_TO_TICKS(1));
+        if (size <= 0)
+            continue;
+
+        s_stats.bytes += size;
+        for (int i = 0; i < size; i++) {
+            if (serial_parser_feed(&parser, chunk[i], &s_stats))
+                handle_frame(&parser);
+        }
+    }
+}
+
+
+/**
+ * @brief Install the driver and start the receive task
+ */
+void serial_link_init(void) {
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+#ifdef SERIAL_UART_NUM
+    uart_config_t uart_config = {
+        .baud_rate  = SERIAL_BAUD_RATE,
+        .data_bits  = UART_DATA_8_BITS,
+        .parity     = UART_PARITY_DISABLE,
+        .stop_bits  = UART_STOP_BITS_1,
+        .flow_ctrl  = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    ESP_ERROR_CHECK(uart_driver_install(SERIAL_UART_NUM, SERIAL_RX_BUFFER_SIZE,
+                                        SERIAL_TX_BUFFER_SIZE, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(SERIAL_UART_NUM, &uart_config));
+#else
+    usb_serial_jtag_driver_config_t usb_config = {
+        .rx_buffer_size = SERIAL_RX_BUFFER_SIZE,
+        .tx_buffer_size = SERIAL_TX_BUFFER_SIZE,
+    };
+    ESP_ERROR_CHECK(usb_serial_jtag_driver_install(&usb_config));
+#endif
+
+    if (xTaskCreate(serial_task, "serial_rx", SERIAL_TASK_STACK_SIZE, NULL,
+                    SERIAL_TASK_PRIORITY, NULL) != pdPASS)
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+
+    ESP_LOGI(TAG, "Serial link started");
+}
+
+
+/**
+ * @brief Decode the last received frame into the framebuffer
+ * @return true if there was a new frame
+ */
+bool serial_link_show(framebuffer_t *fb) {
+    bool shown = false;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_ready) {
+        const uint8_t *payload = s_payloads[s_filled ^ 1];
+        if (serial_decode_pixels(s_ready_type, payload, s_ready_length, fb)) {
+            s_stats.shown++;
+            shown = true;
+        } else {
+            s_stats.invalid++;
+        }
+        s_ready = false;
+    }
+    xSemaphoreGive(s_lock);
+    return shown;
+}
+
+
+void serial_link_get_stats(serial_stats_t *stats) {
+    *stats = s_stats;
+}
@@ -0,0 +1,177 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Serial framing protocol: parser, encoder and pixel decoding
+ */
+// Standard imports
+#include <string.h>  // memcpy
+
+// Local imports
+#include "include/serial_proto.h"
+#include "include/mapping.h"
+
+#define CRC_INIT    0xFFFF
+
+// CRC-16/CCITT (0x1021) of each nibble
+static const uint16_t s_crc_nibbles[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE with the given data
+ */
+uint16_t serial_crc16(uint16_t crc, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 4) ^ s_crc_nibbles[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ s_crc_nibbles[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+
+/**
+ * @brief Reset the parser
+ * @param payload Buffer of SERIAL_MAX_PAYLOAD bytes, can be changed between frames
+ */
+void serial_parser_init(serial_parser_t *parser, uint8_t *payload) {
+    *parser = (serial_parser_t){
+        .state   = SERIAL_PARSER_SYNC_1,
+        .payload = payload,
+    };
+}
+
+
+/**
+ * @brief Parse the next received byte
+ * Corrupted frames are skipped: the parser looks for the next sync bytes.
+ * @return true if a valid frame is complete: type, sequence, length and payload
+ */
+bool serial_parser_feed(serial_parser_t *parser, uint8_t byte, serial_stats_t *stats) {
+    switch (parser->state) {
+        case SERIAL_PARSER_SYNC_1:
+            if (byte == SERIAL_SYNC_1)
+                parser->state = SERIAL_PARSER_SYNC_2;
+            return false;
+
+        case SERIAL_PARSER_SYNC_2:
+            if (byte == SERIAL_SYNC_2) {
+                parser->state = SERIAL_PARSER_HEADER;
+                parser->position = 2;
+            } else if (byte != SERIAL_SYNC_1) {
+                parser->state = SERIAL_PARSER_SYNC_1;
+            }
+            return false;
+
+        case SERIAL_PARSER_HEADER:
+            parser->header[parser->position++] = byte;
+            if (parser->position < SERIAL_HEADER_SIZE)
+                return false;
+
+            parser->length = parser->header[4] | (parser->header[5] << 8);
+            if (parser->length > SERIAL_MAX_PAYLOAD) {
+                stats->invalid++;
+                parser->state = SERIAL_PARSER_SYNC_1;
+                return false;
+            }
+            parser->crc = serial_crc16(CRC_INIT, &parser->header[2], SERIAL_HEADER_SIZE - 2);
+            parser->position = 0;
+            parser->state = parser->length ? SERIAL_PARSER_PAYLOAD : SERIAL_PARSER_CRC;
+            return false;
+
+        case SERIAL_PARSER_PAYLOAD:
+            parser->payload[parser->position++] = byte;
+            if (parser->position == parser->length) {
+                parser->crc = serial_crc16(parser->crc, parser->payload, parser->length);
+                parser->position = 0;
+                parser->state = SERIAL_PARSER_CRC;
+            }
+            return false;
+
+        case SERIAL_PARSER_CRC:
+            if (parser->position++ == 0) {
+                parser->received_crc = byte;
+                return false;
+            }
+            parser->received_crc |= byte << 8;
+            parser->state = SERIAL_PARSER_SYNC_1;
+
+            if (parser->received_crc != parser->crc) {
+                stats->crc_errors++;
+                return false;
+            }
+            parser->type = parser->header[2];
+            parser->sequence = parser->header[3];
+            return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Build a frame
+ * @param frame Buffer of SERIAL_HEADER_SIZE + length + SERIAL_CRC_SIZE bytes
+ * @return Size of the frame
+ */
+size_t serial_encode_frame(uint8_t *frame, uint8_t type, uint8_t sequence,
+                           const uint8_t *payload, uint16_t length) {
+    frame[0] = SERIAL_SYNC_1;
+    frame[1] = SERIAL_SYNC_2;
+    frame[2] = type;
+    frame[3] = sequence;
+    frame[4] = length;
+    frame[5] = length >> 8;
+    memcpy(&frame[SERIAL_HEADER_SIZE], payload, length);
+
+    uint16_t crc = serial_crc16(CRC_INIT, &frame[2], SERIAL_HEADER_SIZE - 2 + length);
+    frame[SERIAL_HEADER_SIZE + length] = crc;
+    frame[SERIAL_HEADER_SIZE + length + 1] = crc >> 8;
+    return SERIAL_HEADER_SIZE + length + SERIAL_CRC_SIZE;
+}
+
+
+/**
+ * @brief Write a pixel payload into the framebuffer, through the strip mapping
+ * LEDs beyond the payload are left unchanged, data beyond the cube is ignored.
+ * @return false if the payload is malformed
+ */
+bool serial_decode_pixels(uint8_t type, const uint8_t *payload, uint16_t length, framebuffer_t *fb) {
+    pix_id_t led = 0;
+
+    if (type == SERIAL_TYPE_PIXELS) {
+        if (length % 3)
+            return false;
+        for (uint16_t i = 0; i < length && led < LED_STRIP_LED_COUNT; i += 3, led++) {
+            voxel_t voxel = g_frame_map[led];
+            fb_set_pixel(fb, voxel.x, voxel.y, voxel.z,
+                         (color_t){ .red = payload[i], .green = payload[i + 1], .blue = payload[i + 2] });
+        }
+        return true;
+    }
+
+    if (type != SERIAL_TYPE_PIXELS_RLE || length % 4)
+        return false;
+    for (uint16_t i = 0; i < length; i += 4) {
+        color_t color = { .red = payload[i + 1], .green = payload[i + 2], .blue = payload[i + 3] };
+        uint16_t end = MIN_(led + payload[i] + 1, LED_STRIP_LED_COUNT);
+
+        for (; led < end; led++) {
+            voxel_t voxel = g_frame_map[led];
+            fb_set_pixel(fb, voxel.x, voxel.y, voxel.z, color);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Rotating solids drawn by the SDF rasterizer
+ * A box hollowed by a pulsing sphere, crossed by a bar orbiting the centre.
+ */
+// Local imports
+#include "include/shapes.h"
+#include "include/commons.h"
+#include "include/sdf.h"
+
+#define SHAPES_FPS         100
+#define SHAPES_TURN_MS     4096  // Period of the rotations
+
+typedef struct {
+    uint32_t time_ms;
+    sdf_field_t field;
+} shapes_state_t;
+
+static const color_t shapes_solid_color = { .red = 0x00, .green = 0x60, .blue = 0xFF };
+static const color_t shapes_bar_color = { .red = 0xFF, .green = 0x50, .blue = 0x00 };
+
+
+/**
+ * @brief Step of the shapes effect
+ * The whole volume is redrawn on each frame.
+ */
+void shapes_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    shapes_state_t *shapes = state;
+    shapes->time_ms = (shapes->time_ms + dt_ms) % (SHAPES_TURN_MS * 3);
+
+    uint8_t angle = shapes->time_ms * 256 / SHAPES_TURN_MS;
+    // Two turns while the yaw does three: back in phase at the end of the period
+    uint8_t pitch = shapes->time_ms * 512 / (SHAPES_TURN_MS * 3);
+    // Centre of the cube and half of its side, Q8
+    int32_t centre = (SIDE_LENGTH - 1) * SDF_ONE / 2;
+    int32_t half = SIDE_LENGTH * SDF_ONE / 2;
+    const int32_t middle[3] = { centre, centre, centre };
+
+    // Box minus a sphere breathing in and out of its faces
+    sdf_shape_t solid[2];
+    const int32_t extents[3] = { half * 5 / 8, half * 5 / 8, half * 5 / 8 };
+    sdf_box(&solid[0], SDF_UNION, middle, extents);
+    sdf_orient(&solid[0].transform, angle, pitch, 0);
+    int32_t radius = half * 5 / 8 + ((half / 4) * sdf_sin(angle * 3) >> 14);
+    sdf_sphere(&solid[1], SDF_SUBTRACT, middle, radius);
+
+    sdf_render(&shapes->field, solid, 2);
+    sdf_shade(&shapes->field, shapes_solid_color, SDF_BLEND_REPLACE, fb);
+
+    // Bar through the centre, turning around Z and swinging up and down
+    int32_t dx = (half * sdf_cos(angle)) >> 14;
+    int32_t dy = (half * sdf_sin(angle)) >> 14;
+    int32_t dz = (half / 2 * sdf_sin(angle * 2)) >> 14;
+    const int32_t from[3] = { centre - dx, centre - dy, centre - dz };
+    const int32_t to[3] = { centre + dx, centre + dy, centre + dz };
+    sdf_shape_t bar;
+    sdf_line(&bar, SDF_UNION, from, to, MAX_(SDF_ONE / 2, half / 6));
+
+    sdf_render(&shapes->field, &bar, 1);
+    sdf_shade(&shapes->field, shapes_bar_color, SDF_BLEND_MAX, fb);
+}
+
+
+const effect_t g_shapes_effect = {
+    .name       = "shapes",
+    .fps        = SHAPES_FPS,
+    .state_size = sizeof(shapes_state_t),
+    .step       = shapes_step,
+};
@@ -0,0 +1,127 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Decoder of the compressed frame streams (see stream.h)
+ *
+ * Frames are decoded from the (memory mapped) stream straight into the
+ * framebuffer; nothing is copied to RAM.
+ */
+// Standard imports
+#include <string.h>  // memcmp
+
+// Local imports
+#include "include/stream.h"
+
+static inline uint16_t read_le16(const uint8_t *data) {
+    return data[0] | (data[1] << 8);
+}
+
+
+static inline uint32_t read_le32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+
+/**
+ * @brief Check the header of the stream and rewind it
+ * @return ESP_ERR_INVALID_ARG if the stream is not for this cube,
+ *      ESP_ERR_INVALID_SIZE if it is truncated.
+ */
+esp_err_t stream_open(stream_t *stream, const uint8_t *data, size_t size) {
+    if (size < STREAM_HEADER_SIZE + STREAM_RECORD_HEADER_SIZE)
+        return ESP_ERR_INVALID_SIZE;
+
+    if (memcmp(data, STREAM_MAGIC, 4) != 0 || data[4] != STREAM_VERSION
+        || data[5] != SIDE_LENGTH)
+        return ESP_ERR_INVALID_ARG;
+
+    uint32_t records_size = read_le32(&data[12]);
+    if (records_size > size - STREAM_HEADER_SIZE)
+        return ESP_ERR_INVALID_SIZE;
+
+    *stream = (stream_t){
+        .data        = data + STREAM_HEADER_SIZE,
+        .size        = records_size,
+        .fps         = read_le16(&data[6]),
+        .frame_count = read_le32(&data[8]),
+    };
+
+    if (!stream->fps || !stream->frame_count || stream->data[0] != STREAM_FRAME_KEY)
+        return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+
+/**
+ * @brief Decode the next frame of the stream into the framebuffer
+ * The framebuffer must hold the previous frame. After the last frame,
+ * the stream starts over.
+ * @return ESP_ERR_INVALID_SIZE if the frame is corrupted; the framebuffer
+ *      may then be partially updated.
+ */
+esp_err_t stream_decode_next(stream_t *stream, framebuffer_t *fb) {
+    if (stream->frame == stream->frame_count) {
+        stream->frame = 0;
+        stream->offset = 0;
+    }
+
+    if (stream->size - stream->offset < STREAM_RECORD_HEADER_SIZE)
+        return ESP_ERR_INVALID_SIZE;
+
+    const uint8_t *record = stream->data + stream->offset;
+    uint16_t payload_size = read_le16(&record[1]);
+    if (stream->size - stream->offset - STREAM_RECORD_HEADER_SIZE < payload_size)
+        return ESP_ERR_INVALID_SIZE;
+
+    if (record[0] == STREAM_FRAME_KEY)
+        fb_clear(fb);
+
+    const uint8_t *op = record + STREAM_RECORD_HEADER_SIZE;
+    const uint8_t *end = op + payload_size;
+    color_t *pixel = &fb->pixels[0][0][0];
+    color_t *last_pixel = pixel + sizeof(fb->pixels) / sizeof(color_t);
+
+    while (op < end) {
+        uint8_t code = *op >> 6;
+        uint8_t count = (*op & 0x3F) + 1;
+        op++;
+
+        if (count > last_pixel - pixel)
+            return ESP_ERR_INVALID_SIZE;
+
+        if (code == STREAM_OP_SKIP) {
+            pixel += count;
+            continue;
+        }
+
+        uint8_t data_size = (code == STREAM_OP_LITERAL) ? 3 * count : 3;
+        if (code > STREAM_OP_RUN || data_size > end - op)
+            return ESP_ERR_INVALID_SIZE;
+
+        for (uint8_t i = 0; i < count; i++, pixel++) {
+            const uint8_t *xor = (code == STREAM_OP_LITERAL) ? op + 3 * i : op;
+            fb_write(fb, pixel, (color_t){
+                .red   = pixel->red ^ xor[0],
+                .green = pixel->green ^ xor[1],
+                .blue  = pixel->blue ^ xor[2],
+            });
+        }
+        op += data_size;
+    }
+
+    stream->offset += STREAM_RECORD_HEADER_SIZE + payload_size;
+    stream->frame++;
+    return ESP_OK;
+}
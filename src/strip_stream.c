@@ -0,0 +1,93 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Conversion of the framebuffer to the byte stream of a strip
+ */
+// Local imports
+#include "include/strip_stream.h"
+#include "include/mapping.h"
+
+
+/**
+ * @brief Convert a strip level to a strip value
+ * @param residue Error accumulated on this channel by the previous frames
+ */
+static inline uint8_t correct_channel(uint16_t level, uint8_t *residue, bool dither) {
+    level += dither ? *residue : 0x80;
+    *residue = level & 0xFF;
+    return level >> 8;
+}
+
+
+/**
+ * @brief Convert the LED of the given strip index to its GRB bytes
+ */
+static inline void convert_led(strip_stream_t *stream, pix_id_t id, uint8_t *grb) {
+    const strip_levels_t *levels = stream->levels;
+    voxel_t voxel = g_frame_map[id];
+    color_t color = stream->fb->pixels[voxel.x][voxel.y][voxel.z];
+
+    uint16_t red = levels->levels[color.red] * levels->scale >> 16;
+    uint16_t green = levels->levels[color.green] * levels->scale >> 16;
+    uint16_t blue = levels->levels[color.blue] * levels->scale >> 16;
+    stream->fractions |= (red | green | blue) & 0xFF;
+
+    grb[0] = correct_channel(green, &levels->residues[id][1], levels->dither);
+    grb[1] = correct_channel(red, &levels->residues[id][0], levels->dither);
+    grb[2] = correct_channel(blue, &levels->residues[id][2], levels->dither);
+}
+
+
+/**
+ * @brief Start the stream of the LEDs [first; first + count[ of the frame
+ * The frame and the levels must not change until the end of the stream.
+ */
+void strip_stream_begin(strip_stream_t *stream, const framebuffer_t *fb, const strip_levels_t *levels,
+                        pix_id_t first, pix_id_t count) {
+    stream->fb = fb;
+    stream->levels = levels;
+    stream->next = first;
+    stream->end = first + count;
+    stream->offset = 3;
+    stream->fractions = 0;
+}
+
+
+/**
+ * @brief Get the next bytes of the stream
+ * @return Number of bytes written in data, < size at the end of the stream
+ */
+size_t strip_stream_read(strip_stream_t *stream, uint8_t *data, size_t size) {
+    size_t count = 0;
+
+    // End of the LED cut by the previous read
+    while (stream->offset < 3 && count < size)
+        data[count++] = stream->grb[stream->offset++];
+
+    // Whole LEDs, straight into the output
+    while (size - count >= 3 && stream->next < stream->end) {
+        convert_led(stream, stream->next++, &data[count]);
+        count += 3;
+    }
+
+    // Start of a LED that doesn't fit
+    if (count < size && stream->next < stream->end) {
+        convert_led(stream, stream->next++, stream->grb);
+        stream->offset = 0;
+        while (count < size)
+            data[count++] = stream->grb[stream->offset++];
+    }
+    return count;
+}
@@ -0,0 +1,38 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Live content streamed by a computer over the serial link
+ */
+// Local imports
+#include "include/tether.h"
+#include "include/serial_link.h"
+
+// Polling rate of the serial link, above the frame rate of the strip
+#define TETHER_FPS    500
+
+
+void tether_step(void *state, uint32_t dt_ms, framebuffer_t *fb) {
+    (void) state;
+    (void) dt_ms;
+
+    serial_link_show(fb);
+}
+
+
+const effect_t g_tether_effect = {
+    .name       = "serial",
+    .fps        = TETHER_FPS,
+    .step       = tether_step,
+};
@@ -0,0 +1,93 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Crossfades, wipes and dissolves between two frames
+ */
+// Standard imports
+#include <string.h>
+
+// Local imports
+#include "include/transition.h"
+#include "include/compositor.h"
+
+// Share of the transition taken by the fade of each voxel of a dissolve
+#define DISSOLVE_FADE_SHIFT    2  // 1/4
+
+
+/**
+ * @brief Opacity of the incoming frame on the given voxel, 255: incoming only
+ */
+static inline uint8_t voxel_opacity(transition_type_t type, uint16_t progress, uint8_t x, uint8_t y, uint8_t z,
+                                    uint16_t index) {
+    int32_t alpha;
+
+    switch (type) {
+    case TRANSITION_WIPE_X:
+    case TRANSITION_WIPE_Y:
+    case TRANSITION_WIPE_Z: {
+        uint8_t position = (type == TRANSITION_WIPE_X) ? x : (type == TRANSITION_WIPE_Y) ? y : z;
+        // The edge, one voxel wide, goes from before the first plane to after the last one
+        alpha = progress * (SIDE_LENGTH + 1) - (position << 8);
+        break;
+    }
+    case TRANSITION_DISSOLVE: {
+        // Start of the fade of the voxel: hash of its index, in the first 3/4
+        uint32_t start = ((index * 2654435761u) >> 24) * (TRANSITION_END - (TRANSITION_END >> DISSOLVE_FADE_SHIFT)) >> 8;
+        alpha = ((int32_t) progress - (int32_t) start) << DISSOLVE_FADE_SHIFT;
+        break;
+    }
+    default:
+        alpha = progress;
+        break;
+    }
+    return MIN_(MAX_(alpha, 0), 255);
+}
+
+
+/**
+ * @brief Draw the given step of the transition from a frame to another
+ * The voxels sharing the same opacity are blended in runs (whole frame
+ * for a crossfade, whole planes for a wipe along X).
+ */
+void transition_blend(transition_type_t type, uint16_t progress,
+                      const framebuffer_t *from, const framebuffer_t *to, framebuffer_t *out) {
+    progress = MIN_(progress, TRANSITION_END);
+    memcpy(out->pixels, from->pixels, sizeof(out->pixels));
+
+    color_t *dst = &out->pixels[0][0][0];
+    const color_t *src = &to->pixels[0][0][0];
+    uint16_t index = 0;
+    uint16_t run_start = 0;
+    uint8_t run_alpha = voxel_opacity(type, progress, 0, 0, 0, 0);
+
+    for (uint8_t x = 0; x < SIDE_LENGTH; x++) {
+        for (uint8_t y = 0; y < SIDE_LENGTH; y++) {
+            for (uint8_t z = 0; z < SIDE_LENGTH; z++, index++) {
+                uint8_t alpha = voxel_opacity(type, progress, x, y, z, index);
+                if (alpha == run_alpha)
+                    continue;
+
+                if (run_alpha)
+                    blend_pixels(&dst[run_start], &src[run_start], index - run_start, BLEND_ALPHA, run_alpha);
+                run_start = index;
+                run_alpha = alpha;
+            }
+        }
+    }
+    if (run_alpha)
+        blend_pixels(&dst[run_start], &src[run_start], index - run_start, BLEND_ALPHA, run_alpha);
+
+    fb_recount(out);
+}
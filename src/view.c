@@ -0,0 +1,155 @@
+// Copyright (C) 2025  Ysard
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+/**
+ * @brief Voxel permutations of the frames: rotations, mirrors and scrolls
+ */
+// Standard imports
+#include <string.h>
+
+// Espressif imports
+#include <esp_log.h>
+
+// Local imports
+#include "include/view.h"
+#include "include/mapping.h"
+
+static const char *TAG = "VIEW";
+
+// Permutations of the axes, even ones first
+static const uint8_t view_permutations[6][3] = {
+    { 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 },
+    { 0, 2, 1 }, { 2, 1, 0 }, { 1, 0, 2 },
+};
+
+
+void view_identity(view_t *view) {
+    memset(view, 0, sizeof(view_t));
+    for (uint8_t i = 0; i < 3; i++)
+        view->m[i][i] = 1;
+}
+
+
+/**
+ * @brief Set one of the VIEW_ROTATION_COUNT rotations of the cube, 0: none
+ * The rotations are the signed permutations of the axes that keep the
+ * orientation (determinant +1). The scroll is kept.
+ */
+void view_set_rotation(view_t *view, uint8_t index) {
+    uint8_t found = 0;
+
+    for (uint8_t perm = 0; perm < 6; perm++) {
+        for (uint8_t signs = 0; signs < 8; signs++) {
+            // Odd permutations need an odd number of flipped axes
+            uint8_t flips = __builtin_popcount(signs);
+            if ((flips + (perm >= 3)) % 2)
+                continue;
+            if (found++ != index % VIEW_ROTATION_COUNT)
+                continue;
+
+            memset(view->m, 0, sizeof(view->m));
+            for (uint8_t i = 0; i < 3; i++)
+                view->m[i][view_permutations[perm][i]] = (signs >> i & 1) ? -1 : 1;
+            return;
+        }
+    }
+}
+
+
+/**
+ * @brief Fold the given matrix after the current one
+ */
+static void view_compose(view_t *view, const int8_t r[3][3]) {
+    int8_t m[3][3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            m[i][j] = r[i][0] * view->m[0][j] + r[i][1] * view->m[1][j] + r[i][2] * view->m[2][j];
+        }
+    }
+    memcpy(view->m, m, sizeof(m));
+}
+
+
+/**
+ * @brief Turn the frame around the given axis (AXIS_X, ...)
+ * @param quarter_turns Counterclockwise seen from the positive end of the axis;
+ *      negative: clockwise.
+ */
+void view_rotate(view_t *view, uint8_t axis, int8_t quarter_turns) {
+    uint8_t b = (axis + 1) % 3;
+    uint8_t c = (axis + 2) % 3;
+    int8_t r[3][3] = { { 0 } };
+    r[axis][axis] = 1;
+    r[b][c] = -1;
+    r[c][b] = 1;
+
+    for (uint8_t turn = 0; turn < (quarter_turns & 3); turn++)
+        view_compose(view, r);
+}
+
+
+void view_mirror(view_t *view, uint8_t axis) {
+    for (uint8_t j = 0; j < 3; j++)
+        view->m[axis][j] = -view->m[axis][j];
+}
+
+
+/**
+ * @brief Move the frame along the given axis; what leaves the cube comes
+ * back on the other side
+ */
+void view_scroll(view_t *view, uint8_t axis, int8_t voxels) {
+    int16_t scroll = (view->scroll[axis] + voxels) % SIDE_LENGTH;
+    view->scroll[axis] = (scroll < 0) ? scroll + SIDE_LENGTH : scroll;
+}
+
+
+/**
+ * @brief Voxel of the frame shown at the given position of the cube
+ */
+static voxel_t view_source(const view_t *view, voxel_t voxel) {
+    const uint8_t last = SIDE_LENGTH - 1;
+    uint8_t p[3] = { voxel.x, voxel.y, voxel.z };
+    // Undo the scroll, then the matrix (its inverse is its transpose),
+    // on coordinates doubled around the centre
+    int8_t centred[3];
+    for (uint8_t i = 0; i < 3; i++)
+        centred[i] = 2 * ((p[i] + SIDE_LENGTH - view->scroll[i]) % SIDE_LENGTH) - last;
+
+    uint8_t s[3];
+    for (uint8_t j = 0; j < 3; j++)
+        s[j] = (view->m[0][j] * centred[0] + view->m[1][j] * centred[1] + view->m[2][j] * centred[2] + last) / 2;
+
+    return (voxel_t){ .x = s[0], .y = s[1], .z = s[2] };
+}
+
+
+/**
+ * @brief Show the next frames through the given view, chained with the
+ * mount rotation (CUBE_MOUNT_ROTATION)
+ * Rebuilds g_frame_map, read while the frames are sent: call output_flush() first.
+ * @param view NULL: no transform
+ */
+void view_apply(const view_t *view) {
+    view_t mount;
+    view_identity(&mount);
+    view_set_rotation(&mount, CUBE_MOUNT_ROTATION);
+
+    for (pix_id_t id = 0; id < LED_STRIP_LED_COUNT; id++) {
+        voxel_t voxel = view_source(&mount, g_voxel_map[id]);
+        g_frame_map[id] = view ? view_source(view, voxel) : voxel;
+    }
+    ESP_LOGD(TAG, "View applied, mount rotation %d", CUBE_MOUNT_ROTATION);
+}